@@ -0,0 +1,442 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef BENCHMARKS_BENCHMARK_H_
+#define BENCHMARKS_BENCHMARK_H_
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/util/Profiler.h"
+
+/**
+ * Minimal benchmark harness in the style of Google Benchmark:
+ *
+ *   static void BM_Example(bench::State& state) {
+ *       setup(state.range(0));
+ *       for (auto _ : state) {
+ *           bench::DoNotOptimize(work());
+ *       }
+ *       state.SetBytesProcessed(state.iterations() * bytes);
+ *   }
+ *   BENCHMARK(BM_Example)->Arg(1000)->Arg(100000);
+ *   BENCHMARK_MAIN();
+ *
+ * The number of iterations grows until the timed loop runs for at least the minimum time.
+ * Flags: --benchmark_filter=<regex>, --benchmark_min_time=<seconds>, --benchmark_format=<console|json>,
+ * --benchmark_out=<file> (json), --benchmark_list_tests
+ */
+namespace bench {
+
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void ClobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+class State {
+    uint64_t max_iterations_;
+    uint64_t iterations_;
+    std::vector<int64_t> args_;
+
+    bool running_;
+    uint64_t wall_start_, cpu_start_;
+    uint64_t wall_ns_, cpu_ns_;
+
+    uint64_t bytes_;
+    uint64_t items_;
+    std::string label_;
+    std::string error_;
+
+    void start() {
+        running_ = true;
+        wall_start_ = profile_wall_ns();
+        cpu_start_ = profile_cpu_ns();
+    }
+
+    void stop() {
+        if (running_) {
+            wall_ns_ += profile_wall_ns() - wall_start_;
+            cpu_ns_ += profile_cpu_ns() - cpu_start_;
+            running_ = false;
+        }
+    }
+
+ public:
+    std::map<std::string, double> counters;
+
+    State(uint64_t max_iterations, const std::vector<int64_t>& args)
+     : max_iterations_(max_iterations), iterations_(0), args_(args), running_(false),
+       wall_start_(0), cpu_start_(0), wall_ns_(0), cpu_ns_(0), bytes_(0), items_(0), label_(), error_(), counters() { }
+
+    struct Value {
+        ~Value() { }  // non-trivial, silences unused variable warnings of 'for (auto _ : state)'
+    };
+
+    class Iterator {
+        State* state_;
+        uint64_t remaining_;
+
+     public:
+        Iterator(State* state, uint64_t remaining) : state_(state), remaining_(remaining) { }
+
+        Value operator*() const {
+            return Value();
+        }
+
+        Iterator& operator++() {
+            --remaining_;
+            return *this;
+        }
+
+        bool operator!=(const Iterator&) {
+            if (remaining_ > 0 && state_->error_.empty()) return true;
+            state_->stop();
+            return false;
+        }
+    };
+
+    Iterator begin() {
+        iterations_ = max_iterations_;
+        start();
+        return Iterator(this, max_iterations_);
+    }
+
+    Iterator end() {
+        return Iterator(this, 0);
+    }
+
+    /**
+     * @brief exclude setup within the timed loop, e.g., rebuilding consumed data structures
+     */
+    void PauseTiming() {
+        stop();
+    }
+
+    void ResumeTiming() {
+        start();
+    }
+
+    int64_t range(size_t i = 0) const {
+        return args_[i];
+    }
+
+    uint64_t iterations() const {
+        return iterations_;
+    }
+
+    void SetBytesProcessed(uint64_t bytes) {
+        bytes_ = bytes;
+    }
+
+    void SetItemsProcessed(uint64_t items) {
+        items_ = items;
+    }
+
+    void SetLabel(const std::string& label) {
+        label_ = label;
+    }
+
+    void SkipWithError(const std::string& error) {
+        error_ = error;
+    }
+
+    friend class Runner;
+};
+
+class Benchmark {
+    std::string name_;
+    std::function<void(State&)> function_;
+    std::vector<std::vector<int64_t>> args_;
+    double min_time_;
+    uint64_t iterations_;
+
+ public:
+    Benchmark(const char* name, std::function<void(State&)> function)
+     : name_(name), function_(function), args_(), min_time_(-1), iterations_(0) { }
+
+    Benchmark* Arg(int64_t arg) {
+        args_.push_back({ arg });
+        return this;
+    }
+
+    Benchmark* Args(const std::vector<int64_t>& args) {
+        args_.push_back(args);
+        return this;
+    }
+
+    /**
+     * @brief all combinations of the given argument lists
+     */
+    Benchmark* ArgsProduct(const std::vector<std::vector<int64_t>>& lists) {
+        std::vector<std::vector<int64_t>> product { { } };
+        for (const std::vector<int64_t>& list : lists) {
+            std::vector<std::vector<int64_t>> next;
+            for (const std::vector<int64_t>& prefix : product) {
+                for (int64_t arg : list) {
+                    next.push_back(prefix);
+                    next.back().push_back(arg);
+                }
+            }
+            product.swap(next);
+        }
+        args_.insert(args_.end(), product.begin(), product.end());
+        return this;
+    }
+
+    Benchmark* MinTime(double seconds) {
+        min_time_ = seconds;
+        return this;
+    }
+
+    /**
+     * @brief fixed number of iterations, e.g., for expensive macro benchmarks
+     */
+    Benchmark* Iterations(uint64_t iterations) {
+        iterations_ = iterations;
+        return this;
+    }
+
+    friend class Runner;
+};
+
+inline std::vector<std::unique_ptr<Benchmark>>& registry() {
+    static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+    return benchmarks;
+}
+
+inline Benchmark* RegisterBenchmark(const char* name, std::function<void(State&)> function) {
+    registry().emplace_back(new Benchmark(name, function));
+    return registry().back().get();
+}
+
+struct Result {
+    std::string name;
+    std::string label;
+    std::string error;
+    uint64_t iterations;
+    double real_time;  // ns per iteration
+    double cpu_time;  // ns per iteration
+    double bytes_per_second;
+    double items_per_second;
+    std::map<std::string, double> counters;
+};
+
+class Runner {
+    std::string filter_ = ".*";
+    double min_time_ = 0.5;
+    std::string format_ = "console";
+    std::string out_;
+    bool list_ = false;
+
+    static std::string json_escape(const std::string& str) {
+        std::string result;
+        for (char c : str) {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result;
+    }
+
+    static std::string number(double value) {
+        std::ostringstream out;
+        out.precision(17);
+        out << value;
+        return out.str();
+    }
+
+    Result run(const Benchmark& benchmark, const std::string& name, const std::vector<int64_t>& args) const {
+        double min_time = benchmark.min_time_ >= 0 ? benchmark.min_time_ : min_time_;
+        uint64_t iterations = benchmark.iterations_ > 0 ? benchmark.iterations_ : 1;
+        while (true) {
+            State state(iterations, args);
+            benchmark.function_(state);
+            state.stop();
+            double seconds = state.wall_ns_ / 1e9;
+            bool done = benchmark.iterations_ > 0 || !state.error_.empty() || seconds >= min_time || iterations >= 1000000000;
+            if (done) {
+                Result result;
+                result.name = name;
+                result.label = state.label_;
+                result.error = state.error_;
+                result.iterations = iterations;
+                result.real_time = static_cast<double>(state.wall_ns_) / iterations;
+                result.cpu_time = static_cast<double>(state.cpu_ns_) / iterations;
+                result.bytes_per_second = seconds > 0 ? state.bytes_ / seconds : 0;
+                result.items_per_second = seconds > 0 ? state.items_ / seconds : 0;
+                result.counters = state.counters;
+                return result;
+            }
+            // predict iterations for the minimum time, with some margin, but grow at most tenfold
+            double multiplier = seconds > 0 ? 1.4 * min_time / seconds : 10;
+            uint64_t next = static_cast<uint64_t>(iterations * std::min(10.0, std::max(multiplier, 1.0)));
+            iterations = std::max(iterations + 1, next);
+        }
+    }
+
+    void print_console(const Result& result) const {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-48s %14.0f ns %14.0f ns %12llu", result.name.c_str(),
+            result.real_time, result.cpu_time, static_cast<unsigned long long>(result.iterations));
+        std::cout << line;
+        if (!result.error.empty()) std::cout << " ERROR: " << result.error;
+        if (result.bytes_per_second > 0) std::cout << " bytes_per_second=" << result.bytes_per_second / (1 << 20) << "Mi/s";
+        if (result.items_per_second > 0) std::cout << " items_per_second=" << result.items_per_second;
+        for (const auto& counter : result.counters) std::cout << " " << counter.first << "=" << counter.second;
+        if (!result.label.empty()) std::cout << " " << result.label;
+        std::cout << std::endl;
+    }
+
+    std::string json(const std::vector<Result>& results, const char* executable) const {
+        char host[256] = { 0 };
+        gethostname(host, sizeof(host) - 1);
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+        std::ostringstream out;
+        out << "{\n  \"context\": {\n";
+        out << "    \"date\": \"" << date << "\",\n";
+        out << "    \"host_name\": \"" << json_escape(host) << "\",\n";
+        out << "    \"executable\": \"" << json_escape(executable) << "\",\n";
+        out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+        out << "    \"library_build_type\": \"release\"\n";
+#else
+        out << "    \"library_build_type\": \"debug\"\n";
+#endif
+        out << "  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+            out << (i > 0 ? ",\n" : "\n") << "    {\n";
+            out << "      \"name\": \"" << json_escape(result.name) << "\",\n";
+            out << "      \"run_type\": \"iteration\",\n";
+            out << "      \"iterations\": " << result.iterations << ",\n";
+            out << "      \"real_time\": " << number(result.real_time) << ",\n";
+            out << "      \"cpu_time\": " << number(result.cpu_time) << ",\n";
+            out << "      \"time_unit\": \"ns\"";
+            if (!result.error.empty()) {
+                out << ",\n      \"error_occurred\": true,\n      \"error_message\": \"" << json_escape(result.error) << "\"";
+            }
+            if (result.bytes_per_second > 0) out << ",\n      \"bytes_per_second\": " << number(result.bytes_per_second);
+            if (result.items_per_second > 0) out << ",\n      \"items_per_second\": " << number(result.items_per_second);
+            for (const auto& counter : result.counters) {
+                out << ",\n      \"" << json_escape(counter.first) << "\": " << number(counter.second);
+            }
+            if (!result.label.empty()) out << ",\n      \"label\": \"" << json_escape(result.label) << "\"";
+            out << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+ public:
+    int main(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&arg](const char* flag) -> const char* {
+                size_t length = std::strlen(flag);
+                return arg.compare(0, length, flag) == 0 && arg.size() > length && arg[length] == '=' ? arg.c_str() + length + 1 : nullptr;
+            };
+            if (const char* v = value("--benchmark_filter")) {
+                filter_ = v;
+            } else if (const char* v = value("--benchmark_min_time")) {
+                min_time_ = std::atof(v);
+            } else if (const char* v = value("--benchmark_format")) {
+                format_ = v;
+            } else if (const char* v = value("--benchmark_out")) {
+                out_ = v;
+            } else if (arg == "--benchmark_list_tests") {
+                list_ = true;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                std::cerr << "Usage: " << argv[0] << " [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>]"
+                    << " [--benchmark_format=<console|json>] [--benchmark_out=<file>] [--benchmark_list_tests]" << std::endl;
+                return 1;
+            }
+        }
+
+        std::regex filter(filter_);
+        std::vector<Result> results;
+        if (format_ == "console" && !list_) {
+#ifndef NDEBUG
+            std::cout << "***WARNING*** Benchmarks were built without NDEBUG, configure with -DCMAKE_BUILD_TYPE=Release" << std::endl;
+#endif
+            char header[256];
+            std::snprintf(header, sizeof(header), "%-48s %17s %17s %12s", "Benchmark", "Time", "CPU", "Iterations");
+            std::cout << header << std::endl << std::string(std::strlen(header), '-') << std::endl;
+        }
+        for (const std::unique_ptr<Benchmark>& benchmark : registry()) {
+            std::vector<std::vector<int64_t>> args = benchmark->args_;
+            if (args.empty()) args.push_back({ });
+            for (const std::vector<int64_t>& arg : args) {
+                std::string name = benchmark->name_;
+                for (int64_t a : arg) name += "/" + std::to_string(a);
+                if (!std::regex_search(name, filter)) continue;
+                if (list_) {
+                    std::cout << name << std::endl;
+                    continue;
+                }
+                results.push_back(run(*benchmark, name, arg));
+                if (format_ == "console") print_console(results.back());
+            }
+        }
+        if (list_) return 0;
+        if (format_ == "json") std::cout << json(results, argv[0]);
+        if (!out_.empty()) {
+            std::ofstream out(out_);
+            out << json(results, argv[0]);
+            if (!out) {
+                std::cerr << "Error writing " << out_ << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+};
+
+}  // namespace bench
+
+#define BENCHMARK_CONCAT2(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT2(a, b)
+#define BENCHMARK(function) \
+    static bench::Benchmark* BENCHMARK_CONCAT(benchmark_, __LINE__) __attribute__((unused)) = bench::RegisterBenchmark(#function, function)
+#define BENCHMARK_MAIN() \
+    int main(int argc, char** argv) { return bench::Runner().main(argc, argv); }
+
+#endif  // BENCHMARKS_BENCHMARK_H_
@@ -0,0 +1,225 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef BENCHMARKS_GENERATORS_H_
+#define BENCHMARKS_GENERATORS_H_
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "src/util/StreamWriter.h"
+
+/**
+ * Deterministic generators of benchmark instances. The same family, scale and seed always
+ * yield the same file, independent of platform and standard library.
+ */
+namespace bench {
+
+enum Family { RANDOM = 0, CIRCUIT = 1, HUBS = 2 };
+
+inline const char* family_name(int family) {
+    switch (family) {
+        case RANDOM: return "random-3sat";
+        case CIRCUIT: return "tseitin-circuit";
+        case HUBS: return "hubs";
+        default: return "unknown";
+    }
+}
+
+class XorShift64 {
+    uint64_t x64;
+
+ public:
+    explicit XorShift64(uint64_t seed = 88172645463325252ull) : x64(seed == 0 ? 88172645463325252ull : seed) { }
+
+    uint64_t operator()() {
+        x64 ^= x64 << 13;
+        x64 ^= x64 >> 7;
+        x64 ^= x64 << 17;
+        return x64;
+    }
+
+    uint64_t operator()(uint64_t range) {
+        return operator()() % range;
+    }
+
+    int literal(unsigned var) {
+        return operator()(2) ? -static_cast<int>(var) : static_cast<int>(var);
+    }
+};
+
+inline void write_clause(StreamWriter& out, std::initializer_list<int> clause) {
+    for (int lit : clause) {
+        out.write_int(lit);
+        out.put(' ');
+    }
+    out.write("0\n", 2);
+}
+
+inline void write_header(StreamWriter& out, uint64_t vars, uint64_t clauses) {
+    out.write("p cnf ", 6);
+    out.write_uint(vars);
+    out.put(' ');
+    out.write_uint(clauses);
+    out.put('\n');
+}
+
+/**
+ * @brief uniform random 3-SAT at clause/variable ratio 4.26, three distinct variables per clause
+ */
+inline void generate_random_3sat(StreamWriter& out, unsigned vars, uint64_t seed) {
+    XorShift64 rng(seed);
+    uint64_t clauses = static_cast<uint64_t>(vars) * 426 / 100;
+    write_header(out, vars, clauses);
+    for (uint64_t i = 0; i < clauses; ++i) {
+        unsigned a = 1 + rng(vars), b, c;
+        do b = 1 + rng(vars); while (b == a && vars > 1);
+        do c = 1 + rng(vars); while ((c == a || c == b) && vars > 2);
+        write_clause(out, { rng.literal(a), rng.literal(b), rng.literal(c) });
+    }
+}
+
+/**
+ * @brief Tseitin encoding of a random circuit of and, or, and xor gates over gates/4 inputs, with the last gate asserted
+ * Gate inputs are drawn from the recent signals or uniformly from all signals, such that the circuit is deep and shared.
+ */
+inline void generate_circuit(StreamWriter& out, unsigned gates, uint64_t seed) {
+    XorShift64 rng(seed);
+    unsigned inputs = std::max(2u, gates / 4);
+    unsigned vars = inputs + gates;
+    std::vector<unsigned> types(gates);
+    uint64_t clauses = 1;
+    for (unsigned g = 0; g < gates; ++g) {
+        types[g] = rng(3);
+        clauses += types[g] == 2 ? 4 : 3;
+    }
+    write_header(out, vars, clauses);
+    for (unsigned g = 0; g < gates; ++g) {
+        int o = inputs + g + 1;
+        unsigned signals = o - 1;
+        auto pick = [&]() -> int {
+            unsigned var = rng(2) ? signals - rng(std::min(signals, 64u)) : 1 + rng(signals);
+            return rng.literal(var);
+        };
+        int a = pick(), b;
+        do b = pick(); while (abs(b) == abs(a));
+        switch (types[g]) {
+            case 0:  // o = a & b
+                write_clause(out, { -o, a });
+                write_clause(out, { -o, b });
+                write_clause(out, { o, -a, -b });
+                break;
+            case 1:  // o = a | b
+                write_clause(out, { o, -a });
+                write_clause(out, { o, -b });
+                write_clause(out, { -o, a, b });
+                break;
+            default:  // o = a ^ b
+                write_clause(out, { -o, a, b });
+                write_clause(out, { -o, -a, -b });
+                write_clause(out, { o, -a, b });
+                write_clause(out, { o, a, -b });
+                break;
+        }
+    }
+    write_clause(out, { static_cast<int>(vars) });
+}
+
+/**
+ * @brief random 3-SAT in which every clause contains one of four hub variables, which thus have huge degree
+ */
+inline void generate_hubs(StreamWriter& out, unsigned vars, uint64_t seed) {
+    XorShift64 rng(seed);
+    vars = std::max(vars, 8u);
+    const unsigned hubs = 4;
+    uint64_t clauses = static_cast<uint64_t>(vars) * 4;
+    write_header(out, vars, clauses);
+    for (uint64_t i = 0; i < clauses; ++i) {
+        unsigned h = 1 + rng(hubs);
+        unsigned a = hubs + 1 + rng(vars - hubs), b;
+        do b = hubs + 1 + rng(vars - hubs); while (b == a);
+        write_clause(out, { rng.literal(h), rng.literal(a), rng.literal(b) });
+    }
+}
+
+/**
+ * @brief generated instances in a temporary directory, which is removed at exit
+ */
+class Instances {
+    std::filesystem::path dir_;
+    std::map<std::string, std::string> paths_;
+
+    Instances() : dir_(std::filesystem::temp_directory_path() / ("gbdc-bench-" + std::to_string(getpid()))), paths_() {
+        std::filesystem::create_directories(dir_);
+    }
+
+ public:
+    ~Instances() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+    static Instances& get() {
+        static Instances instances;
+        return instances;
+    }
+
+    /**
+     * @brief path of generated instance, compressed if extension is .cnf.xz etc.
+     */
+    const std::string& path(int family, unsigned scale, const std::string& ext = ".cnf", uint64_t seed = 1) {
+        std::string name = std::string(family_name(family)) + "-" + std::to_string(scale) + "-" + std::to_string(seed) + ext;
+        auto it = paths_.find(name);
+        if (it != paths_.end()) return it->second;
+        std::string path = (dir_ / name).string();
+        StreamWriter out(path.c_str());
+        switch (family) {
+            case RANDOM: generate_random_3sat(out, scale, seed); break;
+            case CIRCUIT: generate_circuit(out, scale, seed); break;
+            default: generate_hubs(out, scale, seed); break;
+        }
+        out.close();
+        return paths_.emplace(name, path).first->second;
+    }
+
+    /**
+     * @brief path for output files of benchmarks
+     */
+    std::string output(const std::string& name) const {
+        return (dir_ / name).string();
+    }
+};
+
+inline const std::string& instance(int family, unsigned scale, const std::string& ext = ".cnf") {
+    return Instances::get().path(family, scale, ext);
+}
+
+}  // namespace bench
+
+#endif  // BENCHMARKS_GENERATORS_H_
@@ -0,0 +1,104 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+/**
+ * Macro benchmarks of the tools on generated instances of each family at several scales
+ */
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmarks/Benchmark.h"
+#include "benchmarks/Generators.h"
+
+#include "src/identify/GBDHash.h"
+#include "src/identify/ISOHash.h"
+#include "src/extract/CNFBaseFeatures.h"
+#include "src/extract/CNFGateFeatures.h"
+#include "src/transform/IndependentSet.h"
+
+static const std::vector<int64_t> families = { bench::RANDOM, bench::CIRCUIT, bench::HUBS };
+
+static void set_input(bench::State& state, const std::string& path) {
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    state.SetLabel(bench::family_name(state.range(0)));
+}
+
+// args: family, scale
+static void BM_gbdhash(bench::State& state) {
+    const std::string& path = bench::instance(state.range(0), state.range(1));
+    for (auto _ : state) {
+        bench::DoNotOptimize(CNF::gbdhash(path.c_str()));
+    }
+    set_input(state, path);
+}
+BENCHMARK(BM_gbdhash)->ArgsProduct({ families, { 10000, 100000, 1000000 } });
+
+// args: family, scale
+static void BM_isohash(bench::State& state) {
+    const std::string& path = bench::instance(state.range(0), state.range(1));
+    for (auto _ : state) {
+        bench::DoNotOptimize(CNF::isohash(path.c_str()));
+    }
+    set_input(state, path);
+}
+BENCHMARK(BM_isohash)->ArgsProduct({ families, { 10000, 100000, 1000000 } });
+
+// args: family, scale
+static void BM_BaseFeatures(bench::State& state) {
+    const std::string& path = bench::instance(state.range(0), state.range(1));
+    for (auto _ : state) {
+        CNF::BaseFeatures stats(path.c_str());
+        stats.extract();
+        bench::DoNotOptimize(stats.getFeatures().data());
+    }
+    set_input(state, path);
+}
+BENCHMARK(BM_BaseFeatures)->ArgsProduct({ families, { 10000, 100000, 1000000 } });
+
+// args: family, scale
+static void BM_CNFGateFeatures(bench::State& state) {
+    const std::string& path = bench::instance(state.range(0), state.range(1));
+    for (auto _ : state) {
+        CNFGateFeatures stats(path.c_str());
+        stats.extract();
+        bench::DoNotOptimize(stats.getFeatures().data());
+    }
+    set_input(state, path);
+}
+BENCHMARK(BM_CNFGateFeatures)->ArgsProduct({ families, { 1000, 10000, 100000 } })->Iterations(1);
+
+// args: family, scale; the hub variables induce cliques quadratic in the scale, hence the smaller scales of hubs
+static void BM_cnf2kis(bench::State& state) {
+    const std::string& path = bench::instance(state.range(0), state.range(1));
+    std::string output = bench::Instances::get().output("cnf2kis.kis");
+    for (auto _ : state) {
+        IndependentSetFromCNF gen(path.c_str());
+        gen.generate_independent_set_problem(output.c_str());
+    }
+    state.counters["output_bytes"] = std::filesystem::file_size(output);
+    std::remove(output.c_str());
+    set_input(state, path);
+}
+BENCHMARK(BM_cnf2kis)->ArgsProduct({ { bench::RANDOM, bench::CIRCUIT }, { 1000, 10000, 100000 } })
+    ->Args({ bench::HUBS, 1000 })->Args({ bench::HUBS, 3000 })->Iterations(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,158 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+/**
+ * Micro benchmarks of the building blocks: tokenizing, md5, feature statistics, union-find, occurrence lists
+ */
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmarks/Benchmark.h"
+#include "benchmarks/Generators.h"
+
+#include "lib/md5/md5.h"
+#include "lib/md5/md5_mb.h"
+
+#include "src/util/CNFFormula.h"
+#include "src/util/StreamBuffer.h"
+#include "src/extract/Util.h"
+#include "src/extract/gates/OccurrenceList.h"
+
+// args: number of variables, compressed (0: plain, 1: xz)
+static void BM_StreamBuffer_readClause(bench::State& state) {
+    const std::string& path = bench::instance(bench::RANDOM, state.range(0), state.range(1) ? ".cnf.xz" : ".cnf");
+    const std::string& plain = bench::instance(bench::RANDOM, state.range(0));
+    uint64_t literals = 0;
+    for (auto _ : state) {
+        StreamBuffer in(path.c_str());
+        Cl clause;
+        while (in.readClause(clause)) {
+            literals += clause.size();
+        }
+    }
+    bench::DoNotOptimize(literals);
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(plain));
+    state.SetItemsProcessed(literals);
+}
+BENCHMARK(BM_StreamBuffer_readClause)->ArgsProduct({ { 10000, 1000000 }, { 0, 1 } });
+
+// args: message size in bytes
+static void BM_MD5(bench::State& state) {
+    std::vector<char> data(state.range(0), 'x');
+    for (auto _ : state) {
+        MD5 md5;
+        md5.consume(data.data(), data.size());
+        bench::DoNotOptimize(md5.produce());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_MD5)->Arg(64)->Arg(1 << 12)->Arg(1 << 20);
+
+// args: message size in bytes, hashed in all lanes of the widest multi-buffer kernel
+static void BM_MD5_MultiBuffer(bench::State& state) {
+    std::vector<char> data(state.range(0), 'x');
+    md5::mb_t mb;
+    unsigned char sig[MD5_SIZE];
+    for (auto _ : state) {
+        for (unsigned lane = 0; lane < mb.lanes(); ++lane) {
+            mb.start(lane);
+            mb.process(lane, data.data(), data.size());
+            mb.finish(lane);
+        }
+        mb.run();
+        for (unsigned lane = 0; lane < mb.lanes(); ++lane) {
+            mb.get_sig(lane, sig);
+        }
+        bench::DoNotOptimize(sig);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size() * mb.lanes());
+    state.counters["lanes"] = mb.lanes();
+}
+BENCHMARK(BM_MD5_MultiBuffer)->Arg(1 << 12)->Arg(1 << 20);
+
+// args: size of distribution
+static void BM_push_distribution(bench::State& state) {
+    bench::XorShift64 rng;
+    std::vector<unsigned> distribution(state.range(0));
+    for (unsigned& value : distribution) value = rng(1000);
+    std::vector<double> record;
+    for (auto _ : state) {
+        record.clear();
+        push_distribution(record, distribution);
+        bench::DoNotOptimize(record.data());
+    }
+    state.SetItemsProcessed(state.iterations() * distribution.size());
+}
+BENCHMARK(BM_push_distribution)->Arg(1000)->Arg(1000000);
+
+// args: number of variables of random 3-sat clauses
+static void BM_UnionFind(bench::State& state) {
+    bench::XorShift64 rng;
+    unsigned vars = state.range(0);
+    std::vector<Cl> clauses(vars * 2);
+    for (Cl& clause : clauses) {
+        for (unsigned i = 0; i < 3; ++i) clause.push_back(Lit(static_cast<unsigned>(1 + rng(vars)), rng(2)));
+    }
+    for (auto _ : state) {
+        UnionFind uf;
+        for (const Cl& clause : clauses) uf.insert(clause);
+        bench::DoNotOptimize(uf.count_components());
+    }
+    state.SetItemsProcessed(state.iterations() * clauses.size());
+}
+BENCHMARK(BM_UnionFind)->Arg(10000)->Arg(1000000);
+
+// args: family, scale; removes the clauses of every literal in turn
+static void BM_OccurrenceList_remove(bench::State& state) {
+    CNFFormula formula(bench::instance(state.range(0), state.range(1)).c_str());
+    uint64_t removed = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        OccurrenceList index(formula);
+        state.ResumeTiming();
+        for (size_t lit = 2; lit < index.size(); ++lit) {
+            For list = index[lit];
+            removed += list.size();
+            index.remove(list);
+        }
+    }
+    state.SetItemsProcessed(removed);
+    state.SetLabel(bench::family_name(state.range(0)));
+}
+BENCHMARK(BM_OccurrenceList_remove)->ArgsProduct({ { bench::RANDOM, bench::CIRCUIT, bench::HUBS }, { 10000 } });
+
+// args: family, scale; checks every literal
+static void BM_OccurrenceList_isBlockedSet(bench::State& state) {
+    CNFFormula formula(bench::instance(state.range(0), state.range(1)).c_str());
+    OccurrenceList index(formula);
+    unsigned blocked = 0;
+    for (auto _ : state) {
+        for (size_t lit = 2; lit < index.size(); ++lit) {
+            blocked += index.isBlockedSet(Lit(static_cast<unsigned>(lit / 2), lit % 2));
+        }
+    }
+    bench::DoNotOptimize(blocked);
+    state.SetItemsProcessed(state.iterations() * (index.size() - 2));
+    state.SetLabel(bench::family_name(state.range(0)));
+}
+BENCHMARK(BM_OccurrenceList_isBlockedSet)->ArgsProduct({ { bench::RANDOM, bench::CIRCUIT, bench::HUBS }, { 10000, 100000 } });
+
+BENCHMARK_MAIN();
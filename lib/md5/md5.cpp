@@ -83,6 +83,9 @@ namespace md5 {
      */
     void md5_t::process(const void* input, const unsigned int input_length) {
         if (!finished) {
+            /* nothing to do, in particular do not drop previously stored bytes below */
+            if (input_length == 0) return;
+
             unsigned int processed = 0;
 
             /*
@@ -102,9 +105,10 @@ namespace md5 {
             /*
              * While there is enough data to create a complete block, process it.
              */
-            while (processed + md5::BLOCK_SIZE <= input_length) {
-                process_block((unsigned char*)input + processed);
-                processed += md5::BLOCK_SIZE;
+            if (processed + md5::BLOCK_SIZE <= input_length) {
+                unsigned int n = (input_length - processed) / md5::BLOCK_SIZE;
+                process_blocks((unsigned char*)input + processed, n);
+                processed += n * md5::BLOCK_SIZE;
             }
 
             /*
@@ -302,137 +306,179 @@ namespace md5 {
      * input_length - The length of the buffer.
      */
     void md5_t::process_block(const unsigned char* block) {
-    /* Process each 16-word block. */
+        process_blocks(block, 1);
+    }
 
+    /*
+     * process_blocks
+     *
+     * DESCRIPTION:
+     *
+     * Process n consecutive blocks of bytes into a MD5 state structure.
+     * Keeps the accumulators in registers over all blocks.
+     *
+     * RETURNS:
+     *
+     * None.
+     *
+     * ARGUMENTS:
+     *
+     * blocks - A buffer of n * BLOCK_SIZE bytes.
+     *
+     * n - The number of blocks.
+     */
+    void md5_t::process_blocks(const unsigned char* blocks, const unsigned int n) {
         /*
          * we check for when the lower word rolls over, and increment the
          * higher word. we do not need to worry if the higher word rolls over
          * as only the two words we maintain are needed in the function later
          */
-        if (message_length[0] + md5::BLOCK_SIZE < message_length[0])
+        unsigned int length = n * md5::BLOCK_SIZE;
+        if (message_length[0] + length < message_length[0])
             message_length[1]++;
-        message_length[0] += BLOCK_SIZE;
+        message_length[0] += length;
+
+        unsigned int state[4] = { A, B, C, D };
+        md5::compress(state, blocks, n);
+        A = state[0];
+        B = state[1];
+        C = state[2];
+        D = state[3];
+    }
+
+    /*
+     * compress
+     *
+     * DESCRIPTION:
+     *
+     * The MD5 compression function (RFC 1321, 3.4: Step 4) applied to n
+     * consecutive blocks.  Round constants and shifts are immediates and
+     * the boolean functions use the reduced forms with one operation less
+     * than in the RFC, i.e., F(x,y,z) = z ^ (x & (y ^ z)) and
+     * G(x,y,z) = y ^ (z & (x ^ y)).
+     *
+     * RETURNS:
+     *
+     * None.
+     *
+     * ARGUMENTS:
+     *
+     * state - The four accumulators A, B, C and D.
+     *
+     * blocks - A buffer of n * BLOCK_SIZE bytes.
+     *
+     * n - The number of blocks.
+     */
+    void compress(unsigned int state[4], const unsigned char* blocks, size_t n) {
+        unsigned int a = state[0], b = state[1], c = state[2], d = state[3];
+
+        for (; n > 0; --n, blocks += md5::BLOCK_SIZE) {
+            unsigned int X[16];
+            for (unsigned int i = 0; i < 16; i++) {
+                memcpy(X + i, blocks + 4 * i, 4);
+                X[i] = MD5_SWAP(X[i]);
+            }
 
-        // Copy the block into X. */
-        unsigned int X[16];
-        for (unsigned int i = 0; i < 16; i++) {
-            memcpy(X + i, block + 4 * i, 4);
+            unsigned int aa = a, bb = b, cc = c, dd = d;
+
+            #define MD5_STEP(f, a, b, c, d, x, t, s) \
+                a += f(b, c, d) + x + t; \
+                a = (a << s) | (a >> (32 - s)); \
+                a += b;
+
+            #define MD5_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+            #define MD5_G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+            #define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+            #define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+            /* Round 1 */
+            MD5_STEP(MD5_F, a, b, c, d, X[0 ], 0xd76aa478, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[1 ], 0xe8c7b756, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[2 ], 0x242070db, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[3 ], 0xc1bdceee, 22)
+            MD5_STEP(MD5_F, a, b, c, d, X[4 ], 0xf57c0faf, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[5 ], 0x4787c62a, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[6 ], 0xa8304613, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[7 ], 0xfd469501, 22)
+            MD5_STEP(MD5_F, a, b, c, d, X[8 ], 0x698098d8, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[9 ], 0x8b44f7af, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[10], 0xffff5bb1, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[11], 0x895cd7be, 22)
+            MD5_STEP(MD5_F, a, b, c, d, X[12], 0x6b901122, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[13], 0xfd987193, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[14], 0xa679438e, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[15], 0x49b40821, 22)
+
+            /* Round 2 */
+            MD5_STEP(MD5_G, a, b, c, d, X[1 ], 0xf61e2562, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[6 ], 0xc040b340, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[11], 0x265e5a51, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[0 ], 0xe9b6c7aa, 20)
+            MD5_STEP(MD5_G, a, b, c, d, X[5 ], 0xd62f105d, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[10], 0x02441453, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[15], 0xd8a1e681, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[4 ], 0xe7d3fbc8, 20)
+            MD5_STEP(MD5_G, a, b, c, d, X[9 ], 0x21e1cde6, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[14], 0xc33707d6, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[3 ], 0xf4d50d87, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[8 ], 0x455a14ed, 20)
+            MD5_STEP(MD5_G, a, b, c, d, X[13], 0xa9e3e905, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[2 ], 0xfcefa3f8, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[7 ], 0x676f02d9, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[12], 0x8d2a4c8a, 20)
+
+            /* Round 3 */
+            MD5_STEP(MD5_H, a, b, c, d, X[5 ], 0xfffa3942, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[8 ], 0x8771f681, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[11], 0x6d9d6122, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[14], 0xfde5380c, 23)
+            MD5_STEP(MD5_H, a, b, c, d, X[1 ], 0xa4beea44, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[4 ], 0x4bdecfa9, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[7 ], 0xf6bb4b60, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[10], 0xbebfbc70, 23)
+            MD5_STEP(MD5_H, a, b, c, d, X[13], 0x289b7ec6, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[0 ], 0xeaa127fa, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[3 ], 0xd4ef3085, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[6 ], 0x04881d05, 23)
+            MD5_STEP(MD5_H, a, b, c, d, X[9 ], 0xd9d4d039, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[12], 0xe6db99e5, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[15], 0x1fa27cf8, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[2 ], 0xc4ac5665, 23)
+
+            /* Round 4 */
+            MD5_STEP(MD5_I, a, b, c, d, X[0 ], 0xf4292244, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[7 ], 0x432aff97, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[14], 0xab9423a7, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[5 ], 0xfc93a039, 21)
+            MD5_STEP(MD5_I, a, b, c, d, X[12], 0x655b59c3, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[3 ], 0x8f0ccc92, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[10], 0xffeff47d, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[1 ], 0x85845dd1, 21)
+            MD5_STEP(MD5_I, a, b, c, d, X[8 ], 0x6fa87e4f, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[15], 0xfe2ce6e0, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[6 ], 0xa3014314, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[13], 0x4e0811a1, 21)
+            MD5_STEP(MD5_I, a, b, c, d, X[4 ], 0xf7537e82, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[11], 0xbd3af235, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[2 ], 0x2ad7d2bb, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[9 ], 0xeb86d391, 21)
+
+            #undef MD5_STEP
+            #undef MD5_F
+            #undef MD5_G
+            #undef MD5_H
+            #undef MD5_I
+
+            a += aa;
+            b += bb;
+            c += cc;
+            d += dd;
         }
 
-        /* Save A as AA, B as BB, C as CC, and D as DD. */
-        unsigned int AA = A, BB = B, CC = C, DD = D;
-
-        /* Round 1
-         * Let [abcd k s i] denote the operation
-         * a = b + ((a + F(b,c,d) + X[k] + T[i]) <<< s)
-         * Do the following 16 operations
-         * [ABCD  0  7  1]  [DABC  1 12  2]  [CDAB  2 17  3]  [BCDA  3 22  4]
-         * [ABCD  4  7  5]  [DABC  5 12  6]  [CDAB  6 17  7]  [BCDA  7 22  8]
-         * [ABCD  8  7  9]  [DABC  9 12 10]  [CDAB 10 17 11]  [BCDA 11 22 12]
-         * [ABCD 12  7 13]  [DABC 13 12 14]  [CDAB 14 17 15]  [BCDA 15 22 16]
-         */
-        md5::FF(A, B, C, D, X[0 ], 0, 0 );
-        md5::FF(D, A, B, C, X[1 ], 1, 1 );
-        md5::FF(C, D, A, B, X[2 ], 2, 2 );
-        md5::FF(B, C, D, A, X[3 ], 3, 3 );
-        md5::FF(A, B, C, D, X[4 ], 0, 4 );
-        md5::FF(D, A, B, C, X[5 ], 1, 5 );
-        md5::FF(C, D, A, B, X[6 ], 2, 6 );
-        md5::FF(B, C, D, A, X[7 ], 3, 7 );
-        md5::FF(A, B, C, D, X[8 ], 0, 8 );
-        md5::FF(D, A, B, C, X[9 ], 1, 9 );
-        md5::FF(C, D, A, B, X[10], 2, 10);
-        md5::FF(B, C, D, A, X[11], 3, 11);
-        md5::FF(A, B, C, D, X[12], 0, 12);
-        md5::FF(D, A, B, C, X[13], 1, 13);
-        md5::FF(C, D, A, B, X[14], 2, 14);
-        md5::FF(B, C, D, A, X[15], 3, 15);
-
-        /* Round 2
-         * Let [abcd k s i] denote the operation
-         * a = b + ((a + G(b,c,d) + X[k] + T[i]) <<< s)
-         * Do the following 16 operations
-         * [ABCD  1  5 17]  [DABC  6  9 18]  [CDAB 11 14 19]  [BCDA  0 20 20]
-         * [ABCD  5  5 21]  [DABC 10  9 22]  [CDAB 15 14 23]  [BCDA  4 20 24]
-         * [ABCD  9  5 25]  [DABC 14  9 26]  [CDAB  3 14 27]  [BCDA  8 20 28]
-         * [ABCD 13  5 29]  [DABC  2  9 30]  [CDAB  7 14 31]  [BCDA 12 20 32]
-         */
-        md5::GG(A, B, C, D, X[1 ], 0, 16);
-        md5::GG(D, A, B, C, X[6 ], 1, 17);
-        md5::GG(C, D, A, B, X[11], 2, 18);
-        md5::GG(B, C, D, A, X[0 ], 3, 19);
-        md5::GG(A, B, C, D, X[5 ], 0, 20);
-        md5::GG(D, A, B, C, X[10], 1, 21);
-        md5::GG(C, D, A, B, X[15], 2, 22);
-        md5::GG(B, C, D, A, X[4 ], 3, 23);
-        md5::GG(A, B, C, D, X[9 ], 0, 24);
-        md5::GG(D, A, B, C, X[14], 1, 25);
-        md5::GG(C, D, A, B, X[3 ], 2, 26);
-        md5::GG(B, C, D, A, X[8 ], 3, 27);
-        md5::GG(A, B, C, D, X[13], 0, 28);
-        md5::GG(D, A, B, C, X[2 ], 1, 29);
-        md5::GG(C, D, A, B, X[7 ], 2, 30);
-        md5::GG(B, C, D, A, X[12], 3, 31);
-
-        /* Round 3
-         * Let [abcd k s i] denote the operation
-         * a = b + ((a + H(b,c,d) + X[k] + T[i]) <<< s)
-         * Do the following 16 operations
-         * [ABCD  5  4 33]  [DABC  8 11 34]  [CDAB 11 16 35]  [BCDA 14 23 36]
-         * [ABCD  1  4 37]  [DABC  4 11 38]  [CDAB  7 16 39]  [BCDA 10 23 40]
-         * [ABCD 13  4 41]  [DABC  0 11 42]  [CDAB  3 16 43]  [BCDA  6 23 44]
-         * [ABCD  9  4 45]  [DABC 12 11 46]  [CDAB 15 16 47]  [BCDA  2 23 48]
-         */
-        md5::HH(A, B, C, D, X[5 ], 0, 32);
-        md5::HH(D, A, B, C, X[8 ], 1, 33);
-        md5::HH(C, D, A, B, X[11], 2, 34);
-        md5::HH(B, C, D, A, X[14], 3, 35);
-        md5::HH(A, B, C, D, X[1 ], 0, 36);
-        md5::HH(D, A, B, C, X[4 ], 1, 37);
-        md5::HH(C, D, A, B, X[7 ], 2, 38);
-        md5::HH(B, C, D, A, X[10], 3, 39);
-        md5::HH(A, B, C, D, X[13], 0, 40);
-        md5::HH(D, A, B, C, X[0 ], 1, 41);
-        md5::HH(C, D, A, B, X[3 ], 2, 42);
-        md5::HH(B, C, D, A, X[6 ], 3, 43);
-        md5::HH(A, B, C, D, X[9 ], 0, 44);
-        md5::HH(D, A, B, C, X[12], 1, 45);
-        md5::HH(C, D, A, B, X[15], 2, 46);
-        md5::HH(B, C, D, A, X[2 ], 3, 47);
-
-        /* Round 4
-         * Let [abcd k s i] denote the operation
-         * a = b + ((a + I(b,c,d) + X[k] + T[i]) <<< s)
-         * Do the following 16 operations
-         * [ABCD  0  6 49]  [DABC  7 10 50]  [CDAB 14 15 51]  [BCDA  5 21 52]
-         * [ABCD 12  6 53]  [DABC  3 10 54]  [CDAB 10 15 55]  [BCDA  1 21 56]
-         * [ABCD  8  6 57]  [DABC 15 10 58]  [CDAB  6 15 59]  [BCDA 13 21 60]
-         * [ABCD  4  6 61]  [DABC 11 10 62]  [CDAB  2 15 63]  [BCDA  9 21 64]
-         */
-        md5::II(A, B, C, D, X[0 ], 0, 48);
-        md5::II(D, A, B, C, X[7 ], 1, 49);
-        md5::II(C, D, A, B, X[14], 2, 50);
-        md5::II(B, C, D, A, X[5 ], 3, 51);
-        md5::II(A, B, C, D, X[12], 0, 52);
-        md5::II(D, A, B, C, X[3 ], 1, 53);
-        md5::II(C, D, A, B, X[10], 2, 54);
-        md5::II(B, C, D, A, X[1 ], 3, 55);
-        md5::II(A, B, C, D, X[8 ], 0, 56);
-        md5::II(D, A, B, C, X[15], 1, 57);
-        md5::II(C, D, A, B, X[6 ], 2, 58);
-        md5::II(B, C, D, A, X[13], 3, 59);
-        md5::II(A, B, C, D, X[4 ], 0, 60);
-        md5::II(D, A, B, C, X[11], 1, 61);
-        md5::II(C, D, A, B, X[2 ], 2, 62);
-        md5::II(B, C, D, A, X[9 ], 3, 63);
-
-        /* Then perform the following additions. (That is increment each
-        of the four registers by the value it had before this block
-        was started.) */
-        A += AA;
-        B += BB;
-        C += CC;
-        D += DD;
+        state[0] = a;
+        state[1] = b;
+        state[2] = c;
+        state[3] = d;
     }
 
     /*
@@ -28,6 +28,8 @@
 #ifndef LIB_MD5_MD5_H_
 #define LIB_MD5_MD5_H_
 
+#include <cstddef>
+
 /*
  * Size of a standard MD5 signature in bytes.  This definition is for
  * external programs only.  The MD5 routines themselves reference the
@@ -43,6 +45,15 @@ namespace md5 {
 */
 const unsigned int BLOCK_SIZE = 64;
 
+/*
+ * compress
+ *
+ * DESCRIPTION:
+ * Scalar MD5 compression function, processes n consecutive 64 byte blocks into the accumulators state[0..3].
+ * Used by md5_t and by the multi-buffer hasher (see md5_mb.h).
+ */
+extern void compress(unsigned int state[4], const unsigned char* blocks, size_t n);
+
 class md5_t {
  public:
     /*
@@ -130,6 +141,7 @@ class md5_t {
     /* internal functions */
     void initialise();
     void process_block(const unsigned char*);
+    void process_blocks(const unsigned char*, const unsigned int);
     void get_result(void*);
 
     unsigned int A;                             /* accumulator 1 */
@@ -178,23 +190,39 @@ extern void sig_from_string(void* signature, const char* str);
 
 // Markus Iser: The following class just wraps all necessary stuff from above to produce md5 hashes from sequences of characters
 
+#include <cstring>
 #include <string>
 
 class MD5 {
     md5::md5_t hasher;
 
+    // callers feed single tokens, these are staged and handed to the hasher in large chunks
+    char stage[16 * md5::BLOCK_SIZE];
+    unsigned staged;
+
  public:
-    MD5() : hasher() { }
+    MD5() : hasher(), staged(0) { }
     ~MD5() { }
 
     void consume(const char* str, unsigned length) {
         // std::cout << std::string(str, length) << std::endl;
-        hasher.process(str, length);
+        if (staged + length > sizeof(stage)) {
+            hasher.process(stage, staged);
+            staged = 0;
+            if (length > sizeof(stage)) {
+                hasher.process(str, length);
+                return;
+            }
+        }
+        memcpy(stage + staged, str, length);
+        staged += length;
     }
 
     std::string produce() {
         unsigned char sig[MD5_SIZE];
         char str[MD5_STRING_SIZE];
+        if (staged > 0) hasher.process(stage, staged);
+        staged = 0;
         hasher.finish(sig);
         md5::sig_to_string(sig, str, sizeof(str));
         return std::string(str);
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include "md5_mb.h"
+
+namespace md5 {
+
+#if defined(__GNUC__)
+
+    /*
+     * The kernel is written once with the vector extensions of gcc and clang and instantiated for
+     * vectors of 4, 8 and 16 32-bit words. Arithmetic on these vectors operates lane-wise and mixed
+     * vector-scalar operations broadcast the scalar, such that the round steps read like the scalar ones.
+     */
+    typedef unsigned int v4u __attribute__((vector_size(16)));
+    typedef unsigned int v8u __attribute__((vector_size(32)));
+    typedef unsigned int v16u __attribute__((vector_size(64)));
+
+    /*
+     * compress_lanes
+     *
+     * DESCRIPTION:
+     * Process n blocks of each of L messages. state holds the accumulators lane-wise, i.e., A of all
+     * lanes, then B of all lanes, etc. The blocks of lane l are read from blocks[l], which is advanced
+     * by step[l] after each block (idle lanes use step 0 and a dummy block).
+     */
+    template <typename V, unsigned L>
+    static inline __attribute__((always_inline))
+    void compress_lanes(unsigned int* state, const unsigned char** blocks, const size_t* step, size_t n) {
+        V a, b, c, d;
+        memcpy(&a, state, sizeof(V));
+        memcpy(&b, state + L, sizeof(V));
+        memcpy(&c, state + 2 * L, sizeof(V));
+        memcpy(&d, state + 3 * L, sizeof(V));
+
+        const unsigned char* ptr[L];
+        for (unsigned l = 0; l < L; ++l) ptr[l] = blocks[l];
+
+        for (; n > 0; --n) {
+            V X[16];
+            for (unsigned k = 0; k < 16; ++k) {
+                unsigned int words[L];
+                for (unsigned l = 0; l < L; ++l) {
+                    memcpy(words + l, ptr[l] + 4 * k, 4);
+                }
+                memcpy(X + k, words, sizeof(V));
+            }
+            for (unsigned l = 0; l < L; ++l) ptr[l] += step[l];
+
+            V aa = a, bb = b, cc = c, dd = d;
+
+            #define MD5_STEP(f, a, b, c, d, x, t, s) \
+                a += f(b, c, d) + x + (unsigned int)t; \
+                a = (a << s) | (a >> (32 - s)); \
+                a += b;
+
+            #define MD5_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+            #define MD5_G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+            #define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+            #define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+            /* Round 1 */
+            MD5_STEP(MD5_F, a, b, c, d, X[0 ], 0xd76aa478, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[1 ], 0xe8c7b756, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[2 ], 0x242070db, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[3 ], 0xc1bdceee, 22)
+            MD5_STEP(MD5_F, a, b, c, d, X[4 ], 0xf57c0faf, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[5 ], 0x4787c62a, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[6 ], 0xa8304613, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[7 ], 0xfd469501, 22)
+            MD5_STEP(MD5_F, a, b, c, d, X[8 ], 0x698098d8, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[9 ], 0x8b44f7af, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[10], 0xffff5bb1, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[11], 0x895cd7be, 22)
+            MD5_STEP(MD5_F, a, b, c, d, X[12], 0x6b901122, 7 )
+            MD5_STEP(MD5_F, d, a, b, c, X[13], 0xfd987193, 12)
+            MD5_STEP(MD5_F, c, d, a, b, X[14], 0xa679438e, 17)
+            MD5_STEP(MD5_F, b, c, d, a, X[15], 0x49b40821, 22)
+
+            /* Round 2 */
+            MD5_STEP(MD5_G, a, b, c, d, X[1 ], 0xf61e2562, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[6 ], 0xc040b340, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[11], 0x265e5a51, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[0 ], 0xe9b6c7aa, 20)
+            MD5_STEP(MD5_G, a, b, c, d, X[5 ], 0xd62f105d, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[10], 0x02441453, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[15], 0xd8a1e681, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[4 ], 0xe7d3fbc8, 20)
+            MD5_STEP(MD5_G, a, b, c, d, X[9 ], 0x21e1cde6, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[14], 0xc33707d6, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[3 ], 0xf4d50d87, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[8 ], 0x455a14ed, 20)
+            MD5_STEP(MD5_G, a, b, c, d, X[13], 0xa9e3e905, 5 )
+            MD5_STEP(MD5_G, d, a, b, c, X[2 ], 0xfcefa3f8, 9 )
+            MD5_STEP(MD5_G, c, d, a, b, X[7 ], 0x676f02d9, 14)
+            MD5_STEP(MD5_G, b, c, d, a, X[12], 0x8d2a4c8a, 20)
+
+            /* Round 3 */
+            MD5_STEP(MD5_H, a, b, c, d, X[5 ], 0xfffa3942, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[8 ], 0x8771f681, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[11], 0x6d9d6122, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[14], 0xfde5380c, 23)
+            MD5_STEP(MD5_H, a, b, c, d, X[1 ], 0xa4beea44, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[4 ], 0x4bdecfa9, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[7 ], 0xf6bb4b60, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[10], 0xbebfbc70, 23)
+            MD5_STEP(MD5_H, a, b, c, d, X[13], 0x289b7ec6, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[0 ], 0xeaa127fa, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[3 ], 0xd4ef3085, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[6 ], 0x04881d05, 23)
+            MD5_STEP(MD5_H, a, b, c, d, X[9 ], 0xd9d4d039, 4 )
+            MD5_STEP(MD5_H, d, a, b, c, X[12], 0xe6db99e5, 11)
+            MD5_STEP(MD5_H, c, d, a, b, X[15], 0x1fa27cf8, 16)
+            MD5_STEP(MD5_H, b, c, d, a, X[2 ], 0xc4ac5665, 23)
+
+            /* Round 4 */
+            MD5_STEP(MD5_I, a, b, c, d, X[0 ], 0xf4292244, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[7 ], 0x432aff97, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[14], 0xab9423a7, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[5 ], 0xfc93a039, 21)
+            MD5_STEP(MD5_I, a, b, c, d, X[12], 0x655b59c3, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[3 ], 0x8f0ccc92, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[10], 0xffeff47d, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[1 ], 0x85845dd1, 21)
+            MD5_STEP(MD5_I, a, b, c, d, X[8 ], 0x6fa87e4f, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[15], 0xfe2ce6e0, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[6 ], 0xa3014314, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[13], 0x4e0811a1, 21)
+            MD5_STEP(MD5_I, a, b, c, d, X[4 ], 0xf7537e82, 6 )
+            MD5_STEP(MD5_I, d, a, b, c, X[11], 0xbd3af235, 10)
+            MD5_STEP(MD5_I, c, d, a, b, X[2 ], 0x2ad7d2bb, 15)
+            MD5_STEP(MD5_I, b, c, d, a, X[9 ], 0xeb86d391, 21)
+
+            #undef MD5_STEP
+            #undef MD5_F
+            #undef MD5_G
+            #undef MD5_H
+            #undef MD5_I
+
+            a += aa;
+            b += bb;
+            c += cc;
+            d += dd;
+        }
+
+        memcpy(state, &a, sizeof(V));
+        memcpy(state + L, &b, sizeof(V));
+        memcpy(state + 2 * L, &c, sizeof(V));
+        memcpy(state + 3 * L, &d, sizeof(V));
+        for (unsigned l = 0; l < L; ++l) blocks[l] = ptr[l];
+    }
+
+    #if defined(__x86_64__) || defined(__i386__)
+
+    // SSE2 is part of the x86-64 baseline, AVX2 and AVX-512F kernels are compiled for their targets
+    // and only called if the cpu supports them
+    __attribute__((target("sse2")))
+    static void compress_x4(unsigned int* state, const unsigned char** blocks, const size_t* step, size_t n) {
+        compress_lanes<v4u, 4>(state, blocks, step, n);
+    }
+
+    __attribute__((target("avx2")))
+    static void compress_x8(unsigned int* state, const unsigned char** blocks, const size_t* step, size_t n) {
+        compress_lanes<v8u, 8>(state, blocks, step, n);
+    }
+
+    __attribute__((target("avx512f")))
+    static void compress_x16(unsigned int* state, const unsigned char** blocks, const size_t* step, size_t n) {
+        compress_lanes<v16u, 16>(state, blocks, step, n);
+    }
+
+    unsigned mb_lanes() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return 16;
+        if (__builtin_cpu_supports("avx2")) return 8;
+        if (__builtin_cpu_supports("sse2")) return 4;
+        return 1;
+    }
+
+    #else
+
+    // other architectures: 4 lanes with the generic vector extension (e.g., NEON on arm64)
+    static void compress_x4(unsigned int* state, const unsigned char** blocks, const size_t* step, size_t n) {
+        compress_lanes<v4u, 4>(state, blocks, step, n);
+    }
+
+    unsigned mb_lanes() {
+        return 4;
+    }
+
+    #endif
+
+#else
+
+    unsigned mb_lanes() {
+        return 1;
+    }
+
+#endif  // __GNUC__
+
+    mb_t::mb_t(unsigned lanes) : lanes_(), kernel_(nullptr) {
+        unsigned supported = mb_lanes();
+        unsigned width = 1;
+    #if defined(__GNUC__)
+        if (lanes >= 4 && supported >= 4) {
+            width = 4;
+            kernel_ = compress_x4;
+        }
+        #if defined(__x86_64__) || defined(__i386__)
+        if (lanes >= 8 && supported >= 8) {
+            width = 8;
+            kernel_ = compress_x8;
+        }
+        if (lanes >= 16 && supported >= 16) {
+            width = 16;
+            kernel_ = compress_x16;
+        }
+        #endif
+    #else
+        (void)lanes;
+        (void)supported;
+    #endif
+        lanes_.resize(width);
+        for (lane_t& lane : lanes_) {
+            lane.length = 0;
+            lane.offset = 0;
+            lane.busy = false;
+            lane.finished = false;
+        }
+    }
+
+    void mb_t::start(unsigned lane) {
+        lane_t& ln = lanes_[lane];
+        assert(!ln.busy);
+        ln.state[0] = 0x67452301;
+        ln.state[1] = 0xefcdab89;
+        ln.state[2] = 0x98badcfe;
+        ln.state[3] = 0x10325476;
+        ln.length = 0;
+        ln.buffer.clear();
+        ln.offset = 0;
+        ln.busy = true;
+        ln.finished = false;
+    }
+
+    void mb_t::process(unsigned lane, const void* input, size_t length) {
+        lane_t& ln = lanes_[lane];
+        assert(ln.busy && !ln.finished);
+        const unsigned char* bytes = static_cast<const unsigned char*>(input);
+        ln.buffer.insert(ln.buffer.end(), bytes, bytes + length);
+        ln.length += length;
+    }
+
+    void mb_t::finish(unsigned lane) {
+        lane_t& ln = lanes_[lane];
+        assert(ln.busy && !ln.finished);
+        // same padding as md5_t::finish: 0x80, zeros up to 56 mod 64, and the message length in bits
+        uint64_t bits = ln.length << 3;
+        ln.buffer.push_back(0x80);
+        while (ln.buffer.size() % BLOCK_SIZE != BLOCK_SIZE - 8) {
+            ln.buffer.push_back(0);
+        }
+        for (unsigned i = 0; i < 8; ++i) {
+            ln.buffer.push_back(static_cast<unsigned char>(bits >> (8 * i)));
+        }
+        ln.finished = true;
+    }
+
+    void mb_t::run() {
+        const unsigned width = lanes();
+        unsigned active = 0;
+        size_t n = std::numeric_limits<size_t>::max();
+        for (unsigned l = 0; l < width; ++l) {
+            if (busy(l) && !done(l)) {
+                n = std::min(n, pending(l) / BLOCK_SIZE);
+                ++active;
+            }
+        }
+        if (active == 0) return;
+
+        if (active == 1 || kernel_ == nullptr) {
+            for (lane_t& ln : lanes_) {
+                size_t blocks = (ln.buffer.size() - ln.offset) / BLOCK_SIZE;
+                if (ln.busy && blocks > 0) {
+                    compress(ln.state, ln.buffer.data() + ln.offset, blocks);
+                    ln.offset += blocks * BLOCK_SIZE;
+                }
+            }
+        } else if (n > 0) {
+            static const unsigned char dummy[BLOCK_SIZE] = { 0 };
+            unsigned int state[4 * 16];
+            const unsigned char* blocks[16];
+            size_t step[16];
+            for (unsigned l = 0; l < width; ++l) {
+                lane_t& ln = lanes_[l];
+                bool feed = ln.busy && !done(l);
+                for (unsigned j = 0; j < 4; ++j) {
+                    state[j * width + l] = ln.state[j];
+                }
+                blocks[l] = feed ? ln.buffer.data() + ln.offset : dummy;
+                step[l] = feed ? BLOCK_SIZE : 0;
+            }
+            kernel_(state, blocks, step, n);
+            for (unsigned l = 0; l < width; ++l) {
+                lane_t& ln = lanes_[l];
+                if (ln.busy && !done(l)) {
+                    for (unsigned j = 0; j < 4; ++j) {
+                        ln.state[j] = state[j * width + l];
+                    }
+                    ln.offset += n * BLOCK_SIZE;
+                }
+            }
+        }
+
+        // keep only the incomplete block
+        for (lane_t& ln : lanes_) {
+            if (ln.offset > 0) {
+                ln.buffer.erase(ln.buffer.begin(), ln.buffer.begin() + ln.offset);
+                ln.offset = 0;
+            }
+        }
+    }
+
+    void mb_t::get_sig(unsigned lane, void* signature) {
+        lane_t& ln = lanes_[lane];
+        assert(done(lane));
+        memcpy(signature, ln.state, MD5_SIZE);
+        ln.buffer.clear();
+        ln.offset = 0;
+        ln.busy = false;
+        ln.finished = false;
+    }
+
+}  // namespace md5
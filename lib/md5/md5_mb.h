@@ -0,0 +1,140 @@
+/**
+ * Multi-buffer MD5
+ *
+ * Computes the MD5 signatures of several independent messages at once, one message per SIMD lane.
+ * A single MD5 computation is a strictly sequential chain of dependent operations, so it can not
+ * be vectorized by itself. Hashing 4, 8 or 16 messages side by side instead keeps all lanes of
+ * the vector registers busy. The kernel is selected at runtime by the features of the cpu:
+ * 16 lanes with AVX-512F, 8 lanes with AVX2, 4 lanes with SSE2 (or the generic vector extension).
+ * Signatures are identical to the ones of md5_t.
+ */
+
+#ifndef LIB_MD5_MD5_MB_H_
+#define LIB_MD5_MD5_MB_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "md5.h"
+
+namespace md5 {
+
+/*
+ * mb_lanes
+ *
+ * DESCRIPTION:
+ * Number of lanes of the widest multi-buffer kernel supported by this cpu (16, 8, 4, or 1 if there is none).
+ */
+extern unsigned mb_lanes();
+
+class mb_t {
+ public:
+    /*
+     * mb_t
+     *
+     * DESCRIPTION:
+     * Initialize multi-buffer hasher with the widest supported kernel of at most the given number of lanes.
+     */
+    explicit mb_t(unsigned lanes = mb_lanes());
+
+    /*
+     * lanes
+     *
+     * DESCRIPTION:
+     * The number of lanes, i.e., messages which can be hashed at the same time.
+     */
+    unsigned lanes() const {
+        return static_cast<unsigned>(lanes_.size());
+    }
+
+    /*
+     * start
+     *
+     * DESCRIPTION:
+     * Begin a new message in the given lane. The lane must be idle.
+     */
+    void start(unsigned lane);
+
+    /*
+     * process
+     *
+     * DESCRIPTION:
+     * Append bytes to the message of the given lane. The bytes are buffered until the next call to run.
+     */
+    void process(unsigned lane, const void* input, size_t length);
+
+    /*
+     * finish
+     *
+     * DESCRIPTION:
+     * Append padding and length to the message of the given lane. No more bytes can be appended afterwards.
+     */
+    void finish(unsigned lane);
+
+    /*
+     * run
+     *
+     * DESCRIPTION:
+     * Process all blocks which are buffered in every busy lane with the SIMD kernel.
+     * If only one lane is busy, its blocks are processed with the scalar kernel.
+     */
+    void run();
+
+    /*
+     * pending
+     *
+     * DESCRIPTION:
+     * Number of bytes buffered in the given lane.
+     */
+    size_t pending(unsigned lane) const {
+        return lanes_[lane].buffer.size() - lanes_[lane].offset;
+    }
+
+    /*
+     * busy
+     *
+     * DESCRIPTION:
+     * True if a message was started in the given lane and its signature was not yet retrieved.
+     */
+    bool busy(unsigned lane) const {
+        return lanes_[lane].busy;
+    }
+
+    /*
+     * done
+     *
+     * DESCRIPTION:
+     * True if the message of the given lane is finished and all its blocks are processed.
+     */
+    bool done(unsigned lane) const {
+        return lanes_[lane].busy && lanes_[lane].finished && pending(lane) == 0;
+    }
+
+    /*
+     * get_sig
+     *
+     * DESCRIPTION:
+     * Retrieve the signature of the given lane, which must be done. The lane becomes idle.
+     */
+    void get_sig(unsigned lane, void* signature);
+
+ private:
+    struct lane_t {
+        unsigned int state[4];
+        uint64_t length;
+        std::vector<unsigned char> buffer;
+        size_t offset;
+        bool busy;
+        bool finished;
+    };
+
+    typedef void (*kernel_t)(unsigned int* state, const unsigned char** blocks, const size_t* step, size_t n);
+
+    std::vector<lane_t> lanes_;
+    kernel_t kernel_;
+};
+
+}  // namespace md5
+
+#endif  // LIB_MD5_MD5_MB_H_
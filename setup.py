@@ -20,13 +20,25 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 from setuptools import setup, Extension
 import os
 import platform
+import sys
 
 
+# optional: parallel decompression of multi-block xz and multi-frame zstd inputs, if the headers are installed
+libraries = ["archive", "cadical", "pthread"]
+define_macros = []
+include_prefixes = [sys.prefix, "/usr", "/usr/local", "/opt/homebrew"]
+# and io_uring for reading ahead in batch mode
+for lib, header, macro in [("lzma", "lzma.h", "GBDC_HAVE_LZMA"), ("zstd", "zstd.h", "GBDC_HAVE_ZSTD"), ("uring", "liburing.h", "GBDC_HAVE_LIBURING")]:
+    if any(os.path.exists(os.path.join(prefix, "include", header)) for prefix in include_prefixes):
+        libraries.append(lib)
+        define_macros.append((macro, None))
+
 module = Extension("gbdc",
-                   libraries=["archive", "cadical"],
+                   libraries=libraries,
+                   define_macros=define_macros,
                    library_dirs=["lib", os.path.abspath("./build/solvers/src/cadical_external/build")],
                    include_dirs=["."],
-                   sources=["src/gbdlib.cc", "./lib/md5/md5.cpp"])
+                   sources=["src/gbdlib.cc", "./lib/md5/md5.cpp", "./lib/md5/md5_mb.cpp"])
 
 setup(name="gbdc",
       version="0.2.45",
@@ -0,0 +1,154 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+/**
+ * Client of `gbdc serve`: sends one request per file to the server and prints the responses as they arrive,
+ * one line of JSON each, e.g., {"id": 0, "file": "/path/to/instance.cnf", "result": "<hash>"}.
+ * With tool "raw", request lines are read from stdin and sent as they are.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "lib/argparse/argparse.hpp"
+#include "src/util/JsonLine.h"
+
+static bool send_all(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t length = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (length < 0 && errno == EINTR) continue;
+        if (length <= 0) return false;
+        done += length;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    argparse::ArgumentParser argparse("gbdc-client");
+
+    argparse.add_argument("tool").help("Tool to run on each file: id|identify, gbdhash, opbhash, pqbfhash, isohash, ingest, extract, gates, or raw (send request lines from stdin)");
+    argparse.add_argument("files").help("Paths of input files, - to read paths from stdin (one per line), options go before the tool").remaining();
+
+    argparse.add_argument("-s", "--socket")
+        .help("Path of the socket of gbdc serve")
+        .required();
+
+    argparse.add_argument("-t", "--timeout")
+        .help("Timeout in seconds of cpu time per request (default: 0, default of server)")
+        .default_value(0)
+        .scan<'i', int>();
+
+    argparse.add_argument("-w", "--wallout")
+        .help("Timeout in milliseconds of wall-clock time per request (default: 0, default of server)")
+        .default_value(0)
+        .scan<'i', int>();
+
+    argparse.add_argument("-m", "--memout")
+        .help("Memout in megabytes per request (default: 0, default of server)")
+        .default_value(0)
+        .scan<'i', int>();
+
+    try {
+        argparse.parse_args(argc, argv);
+    }
+    catch (const std::runtime_error& err) {
+        std::cout << err.what() << std::endl;
+        std::cout << argparse;
+        exit(0);
+    }
+
+    std::string toolname = argparse.get("tool");
+    std::string socket = argparse.get("socket");
+    std::vector<std::string> files;
+    if (argparse.is_used("files")) files = argparse.get<std::vector<std::string>>("files");
+
+    // requests are built before connecting, paths are made absolute as the server may run in another directory
+    std::string requests;
+    if (toolname == "raw") {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (!line.empty()) requests += line + "\n";
+        }
+    } else {
+        if (files.size() == 1 && files[0] == "-") {
+            files.clear();
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                if (!line.empty()) files.push_back(line);
+            }
+        }
+        std::string limits;
+        if (argparse.get<int>("timeout") > 0) limits += ", \"timeout\": " + std::to_string(argparse.get<int>("timeout"));
+        if (argparse.get<int>("wallout") > 0) limits += ", \"wallout\": " + std::to_string(argparse.get<int>("wallout"));
+        if (argparse.get<int>("memout") > 0) limits += ", \"memout\": " + std::to_string(argparse.get<int>("memout"));
+        for (size_t i = 0; i < files.size(); ++i) {
+            std::string path = std::filesystem::absolute(files[i]).string();
+            requests += "{\"id\": " + std::to_string(i) + ", \"tool\": " + json_string(toolname) + ", \"file\": " + json_string(path) + limits + "}\n";
+        }
+    }
+
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socket << std::endl;
+        return 1;
+    }
+    std::strncpy(address.sun_path, socket.c_str(), sizeof(address.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Error connecting to " << socket << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // send from another thread, as the server answers while it reads and blocks if responses are not read
+    bool sent = true;
+    std::thread sender([&] {
+        sent = send_all(fd, requests);
+        ::shutdown(fd, SHUT_WR);
+    });
+
+    // the server closes the connection once all requests are answered
+    std::vector<char> buffer(1 << 16);
+    for (;;) {
+        ssize_t length = ::recv(fd, buffer.data(), buffer.size(), 0);
+        if (length < 0 && errno == EINTR) continue;
+        if (length <= 0) break;
+        std::cout.write(buffer.data(), length);
+    }
+    std::cout.flush();
+    sender.join();
+    ::close(fd);
+
+    if (!sent) {
+        std::cerr << "Error sending requests to " << socket << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -21,6 +21,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <array>
 #include <cstdio>
 #include <filesystem>
+#include <fstream>
 
 #include "lib/argparse/argparse.hpp"
 #include "lib/ipasir.h"
@@ -35,29 +36,228 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include "src/extract/CNFGateFeatures.h"
 #include "src/extract/CNFBaseFeatures.h"
+#include "src/extract/CNFSinglePass.h"
 #include "src/extract/WCNFBaseFeatures.h"
 #include "src/extract/OPBBaseFeatures.h"
 
 #include "src/util/StreamCompressor.h"
+#include "src/util/ResultCache.h"
+#include "src/util/Profiler.h"
+#include "src/util/ArchiveReader.h"
+#include "src/util/Server.h"
+
+// extension of the instance format, e.g., .cnf for instance.cnf.xz
+static std::string format_extension(const std::string& filename) {
+    std::string ext = std::filesystem::path(filename).extension();
+    if (ext == ".xz" || ext == ".lzma" || ext == ".bz2" || ext == ".gz" || ext == ".zst") {
+        ext = std::filesystem::path(filename).stem().extension();
+    }
+    return ext;
+}
+
+static void print_record(const std::vector<std::string>& names, const std::vector<double>& record) {
+    for (unsigned i = 0; i < record.size(); i++) {
+        std::cout << names[i] << "=" << record[i] << std::endl;
+    }
+}
+
+/**
+ * Runs the given identification or extraction tool on each instance in the archive, decompressing the archive once.
+ * Hashes are printed as "<hash> <entry>", features are preceded by "file=<entry>".
+ */
+static void process_archive(const std::string& toolname, const std::string& filename) {
+    ArchiveReader archive(filename.c_str());
+    while (archive.next()) {
+        const char* entry = archive.filename();
+        const std::string& path = archive.path();
+        std::string ext = format_extension(path);
+        try {
+            std::string hash;
+            if (toolname == "gbdhash" || ((toolname == "id" || toolname == "identify") && (ext == ".cnf" || ext == ".wecnf"))) {
+                hash = CNF::gbdhash(entry);
+            } else if (toolname == "opbhash" || ((toolname == "id" || toolname == "identify") && ext == ".opb")) {
+                hash = OPB::gbdhash(entry);
+            } else if (toolname == "pqbfhash" || ((toolname == "id" || toolname == "identify") && (ext == ".qcnf" || ext == ".qdimacs"))) {
+                hash = PQBF::gbdhash(entry);
+            } else if ((toolname == "id" || toolname == "identify") && ext == ".wcnf") {
+                hash = WCNF::gbdhash(entry);
+            } else if (toolname == "isohash" && ext == ".cnf") {
+                hash = CNF::isohash(entry);
+            } else if (toolname == "isohash" && ext == ".wcnf") {
+                hash = WCNF::isohash(entry);
+            } else if (toolname == "ingest") {
+                CNF::SinglePass stats(entry);
+                stats.extract();
+                std::cout << "file=" << path << std::endl;
+                std::cout << "gbdhash=" << stats.getGBDHash() << std::endl;
+                std::cout << "isohash=" << stats.getIsoHash() << std::endl;
+                print_record(stats.getNames(), stats.getFeatures());
+            } else if (toolname == "extract" && ext == ".cnf") {
+                CNF::BaseFeatures stats(entry);
+                stats.extract();
+                std::cout << "file=" << path << std::endl;
+                print_record(stats.getNames(), stats.getFeatures());
+            } else if (toolname == "extract" && ext == ".wcnf") {
+                WCNF::BaseFeatures stats(entry);
+                stats.extract();
+                std::cout << "file=" << path << std::endl;
+                print_record(stats.getNames(), stats.getFeatures());
+            } else if (toolname == "extract" && ext == ".opb") {
+                OPB::BaseFeatures stats(entry);
+                stats.extract();
+                std::cout << "file=" << path << std::endl;
+                print_record(stats.getNames(), stats.getFeatures());
+            } else if (toolname == "gates") {
+                CNFGateFeatures stats(entry);
+                stats.extract();
+                std::cout << "file=" << path << std::endl;
+                print_record(stats.getNames(), stats.getFeatures());
+            } else {
+                std::cerr << "Skipping entry of unknown format: " << path << std::endl;
+            }
+            if (!hash.empty()) std::cout << hash << " " << path << std::endl;
+        }
+        catch (ParserException& e) {
+            std::cerr << "Error parsing entry: " << path << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+/**
+ * Answers one request of the server, e.g., {"tool": "extract", "file": "instance.cnf.xz"}, with the hash as JSON string,
+ * or the features as JSON object, respectively. Tools are the ones which also accept archives.
+ */
+static std::string serve_request(const JsonObject& request, ResultCache& cache) {
+    std::string toolname = request.get_string("tool", "identify");
+    std::string file = request.get_string("file");
+    if (file.empty()) throw std::invalid_argument("missing file");
+    const char* filename = file.c_str();
+    std::string ext = format_extension(file);
+    bool identify = toolname == "id" || toolname == "identify";
+    if (toolname == "gbdhash" || (identify && (ext == ".cnf" || ext == ".wecnf"))) {
+        return json_string(cache.fetch(filename, "cnf.gbdhash", [&] { return CNF::gbdhash(filename); }));
+    } else if (toolname == "opbhash" || (identify && ext == ".opb")) {
+        return json_string(cache.fetch(filename, "opb.gbdhash", [&] { return OPB::gbdhash(filename); }));
+    } else if (toolname == "pqbfhash" || (identify && (ext == ".qcnf" || ext == ".qdimacs"))) {
+        return json_string(cache.fetch(filename, "pqbf.gbdhash", [&] { return PQBF::gbdhash(filename); }));
+    } else if (identify && ext == ".wcnf") {
+        return json_string(cache.fetch(filename, "wcnf.gbdhash", [&] { return WCNF::gbdhash(filename); }));
+    } else if (toolname == "isohash" && ext == ".cnf") {
+        return json_string(cache.fetch(filename, "cnf.isohash", [&] { return CNF::isohash(filename); }));
+    } else if (toolname == "isohash" && ext == ".wcnf") {
+        return json_string(cache.fetch(filename, "wcnf.isohash", [&] { return WCNF::isohash(filename); }));
+    } else if (toolname == "ingest") {
+        std::string hash, isohash;
+        std::vector<double> record;
+        CNF::SinglePass stats(filename);
+        if (!cache.get(filename, "cnf.gbdhash", &hash) || !cache.get(filename, "cnf.isohash", &isohash)
+                || !cache.get(filename, "cnf.base_features", &record)) {
+            stats.extract();
+            hash = stats.getGBDHash();
+            isohash = stats.getIsoHash();
+            record = stats.getFeatures();
+            cache.put(filename, "cnf.gbdhash", hash);
+            cache.put(filename, "cnf.isohash", isohash);
+            cache.put(filename, "cnf.base_features", record);
+        }
+        std::string features = json_record(stats.getNames(), record);
+        return "{\"gbdhash\": " + json_string(hash) + ", \"isohash\": " + json_string(isohash) + (record.empty() ? "}" : ", " + features.substr(1));
+    } else if (toolname == "extract" && ext == ".cnf") {
+        CNF::BaseFeatures stats(filename);
+        return json_record(stats.getNames(), cache.fetch(filename, "cnf.base_features", [&] {
+            stats.extract();
+            return stats.getFeatures();
+        }));
+    } else if (toolname == "extract" && ext == ".wcnf") {
+        WCNF::BaseFeatures stats(filename);
+        return json_record(stats.getNames(), cache.fetch(filename, "wcnf.base_features", [&] {
+            stats.extract();
+            return stats.getFeatures();
+        }));
+    } else if (toolname == "extract" && ext == ".opb") {
+        OPB::BaseFeatures stats(filename);
+        return json_record(stats.getNames(), cache.fetch(filename, "opb.base_features", [&] {
+            stats.extract();
+            return stats.getFeatures();
+        }));
+    } else if (toolname == "gates") {
+        CNFGateFeatures stats(filename);
+        stats.extract();
+        return json_record(stats.getNames(), stats.getFeatures());
+    }
+    throw std::invalid_argument("unsupported tool or format: " + toolname + " " + file);
+}
 
 int main(int argc, char** argv) {
     argparse::ArgumentParser argparse("CNF Tools");
 
-    argparse.add_argument("tool").help("Select Tool: solve, id|identify (gbdhash, opbhash, pqbfhash), isohash, normalize, sanitize, checksani, cnf2kis, extract, gates")
+    argparse.add_argument("tool").help("Select Tool: solve, id|identify (gbdhash, opbhash, pqbfhash), isohash, ingest (gbdhash, isohash and base features in one pass), normalize, sanitize, checksani, cnf2kis, extract, gates, serve (answer requests on --socket)")
         .default_value("identify")
         .action([](const std::string& value) {
-            static const std::vector<std::string> choices = { "solve", "id", "identify", "gbdhash", "opbhash", "pqbfhash", "isohash", "normalize", "sanitize", "checksani", "cnf2kis", "extract", "gates", "test" };
+            static const std::vector<std::string> choices = { "solve", "id", "identify", "gbdhash", "opbhash", "pqbfhash", "isohash", "ingest", "normalize", "sanitize", "checksani", "cnf2kis", "extract", "gates", "serve", "test" };
             if (std::find(choices.begin(), choices.end(), value) != choices.end()) {
                 return value;
             }
             return std::string{ "identify" };
         });
 
-    argparse.add_argument("file").help("Path to Input File");
-    argparse.add_argument("-o", "--output").help("Path to Output File (used by cnf2kis if set, default is stdout)").default_value(std::string("-"));
+    argparse.add_argument("file").help("Path to Input File, or to an archive (.tar, .tar.xz, .zip, etc.) whose instances are identified or extracted one by one")
+        .default_value(std::string(""));
+    argparse.add_argument("-o", "--output").help("Path to Output File of cnf2kis, normalize, and sanitize, compressed if extension is .xz, .lzma, .zst, .gz, or .bz2 (default is stdout)").default_value(std::string("-"));
+
+    argparse.add_argument("--graph-format")
+        .help("Graph encoding of cnf2kis: kis (each edge twice), dimacs (each edge once), metis (adjacency lists), or csr (binary) (default: chosen by extension .dimacs, .col, .graph, .metis, .csr, otherwise kis)")
+        .default_value(std::string(""))
+        .action([](const std::string& value) {
+            static const std::vector<std::string> choices = { "kis", "dimacs", "metis", "csr" };
+            if (std::find(choices.begin(), choices.end(), value) == choices.end()) {
+                throw std::runtime_error("Unknown graph format: " + value);
+            }
+            return value;
+        });
+
+    argparse.add_argument("--compression")
+        .help("Compression filter of output file: xz, lzma, zstd, gzip, bzip2, or none (default: chosen by extension)")
+        .default_value(std::string(""))
+        .action([](const std::string& value) {
+            static const std::vector<std::string> choices = { "xz", "lzma", "zstd", "gzip", "bzip2", "none" };
+            if (std::find(choices.begin(), choices.end(), value) == choices.end()) {
+                throw std::runtime_error("Unknown compression filter: " + value);
+            }
+            return value;
+        });
+
+    argparse.add_argument("--level")
+        .help("Compression level of output file (default: -1, default of filter)")
+        .default_value(-1)
+        .scan<'i', int>();
+
+    argparse.add_argument("--compression-threads")
+        .help("Number of compression threads for xz and zstd output (default: 1, 0 for one per core)")
+        .default_value(1)
+        .scan<'i', int>();
+
+    argparse.add_argument("--decompression-threads")
+        .help("Number of threads for decompressing multi-block xz and multi-frame zstd input (default: 1, serial, 0 for one per core)")
+        .default_value(1)
+        .scan<'i', int>();
+
+    argparse.add_argument("--socket")
+        .help("Path of the Unix domain socket on which serve accepts requests in newline-delimited JSON")
+        .default_value(std::string(""));
+
+    argparse.add_argument("--threads")
+        .help("Number of worker threads, 0 for one per core (default: one per core for serve, up to 8 for cnf2kis, and 1 for gates, isohash, and sanitize)")
+        .default_value(0)
+        .scan<'i', int>();
 
     argparse.add_argument("-t", "--timeout")
-        .help("Timeout in seconds (default: 0, disabled)")
+        .help("Timeout in seconds of cpu time (default: 0, disabled)")
+        .default_value(0)
+        .scan<'i', int>();
+
+    argparse.add_argument("-w", "--wallout")
+        .help("Timeout in milliseconds of wall-clock time (default: 0, disabled)")
         .default_value(0)
         .scan<'i', int>();
 
@@ -76,11 +276,24 @@ int main(int argc, char** argv) {
         .default_value(0)
         .scan<'i', int>();
 
+    argparse.add_argument("-c", "--cache")
+        .help("Path to result cache directory for hashes and base features (default: $GBDC_CACHE, disabled if unset)");
+
+    argparse.add_argument("-b", "--batch")
+        .help("Batch mode for gbdhash: read list of files (one per line, - for stdin) from given file and hash them side by side")
+        .default_value(false)
+        .implicit_value(true);
+
     argparse.add_argument("-r", "--repeat")
         .help("Give number of root selections for gate recognition")
         .default_value(1)
         .scan<'i', int>();
 
+    argparse.add_argument("--profile")
+        .help("Print wall time, cpu time, and processed bytes per stage as json to stderr")
+        .default_value(false)
+        .implicit_value(true);
+
     try {
         argparse.parse_args(argc, argv);
     }
@@ -90,117 +303,208 @@ int main(int argc, char** argv) {
         exit(0);
     }
 
-    std::string filename = argparse.get("file");
+    // the input file is required by all tools but serve
+    if (!argparse.is_used("file") && !(argparse.is_used("tool") && argparse.get("tool") == "serve")) {
+        std::cout << "1 argument(s) expected. 0 provided." << std::endl;
+        std::cout << argparse;
+        exit(0);
+    }
+
     std::string toolname = argparse.get("tool");
+
+    std::string filename = argparse.get("file");
     std::string output = argparse.get("output");
     int verbose = argparse.get<int>("verbose");
     int repeat = argparse.get<int>("repeat");
+    bool batch = argparse.get<bool>("batch");
+    bool profile = argparse.get<bool>("profile");
+    std::optional<std::string> cachedir = argparse.present("--cache");
+
+    CompressionOptions compression;
+    compression.filter = argparse.get("compression");
+    compression.level = argparse.get<int>("level");
+    compression.threads = std::max(0, argparse.get<int>("compression-threads"));
+    decompression_threads() = std::max(0, argparse.get<int>("decompression-threads"));
+
+    ResultCache cache(cachedir ? cachedir->c_str() : nullptr);
+
+    if (toolname == "serve") {
+        // limits apply per request, the ones given here are the defaults of requests
+        Server::Limits defaults;
+        defaults.timeout = std::max(0, argparse.get<int>("timeout"));
+        defaults.wallout = std::max(0, argparse.get<int>("wallout"));
+        defaults.memout = std::max(0, argparse.get<int>("memout"));
+        std::string socket = argparse.get("socket");
+        if (socket.empty()) socket = filename;
+        if (socket.empty()) {
+            std::cerr << "serve requires --socket <path>" << std::endl;
+            return 1;
+        }
+        try {
+            Server server(socket, std::max(0, argparse.get<int>("threads")), [&cache] (const JsonObject& request) {
+                return serve_request(request, cache);
+            }, defaults);
+            server.stop_on_signals();
+            std::cerr << "c Serving on " << socket << " with " << server.threads() << " threads" << std::endl;
+            server.run();
+        }
+        catch (std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
-    ResourceLimits limits(argparse.get<int>("timeout"), argparse.get<int>("memout"), argparse.get<int>("fileout"));
+    ResourceLimits limits(argparse.get<int>("timeout"), argparse.get<int>("memout"), argparse.get<int>("fileout"), argparse.get<int>("wallout"));
     limits.set_rlimits();
 
+    Profiler::instance().enable(profile);
+
     std::cerr << "c Running: " << toolname << " " << filename << std::endl;
 
+    static const std::vector<std::string> archive_tools = { "id", "identify", "gbdhash", "opbhash", "pqbfhash", "isohash", "ingest", "extract", "gates" };
+
     try {
-        if (toolname == "id" || toolname == "identify") {
-            std::string ext = std::filesystem::path(filename).extension();
-            if (ext == ".xz" || ext == ".lzma" || ext == ".bz2" || ext == ".gz") {
-                ext = std::filesystem::path(filename).stem().extension();
-            }
+        if (!batch && ArchiveReader::is_archive(filename) && std::find(archive_tools.begin(), archive_tools.end(), toolname) != archive_tools.end()) {
+            process_archive(toolname, filename);
+        } else if (toolname == "id" || toolname == "identify") {
+            std::string ext = format_extension(filename);
             if (ext == ".cnf" || ext == ".wecnf") {
                 std::cerr << "Detected CNF, using CNF hash" << std::endl;
-                std::cout << CNF::gbdhash(filename.c_str()) << std::endl;
+                std::cout << cache.fetch(filename.c_str(), "cnf.gbdhash", [&] { return CNF::gbdhash(filename.c_str()); }) << std::endl;
             }
             else if (ext == ".opb") {
                 std::cerr << "Detected OPB, using OPB hash" << std::endl;
-                std::cout << OPB::gbdhash(filename.c_str()) << std::endl;
+                std::cout << cache.fetch(filename.c_str(), "opb.gbdhash", [&] { return OPB::gbdhash(filename.c_str()); }) << std::endl;
             }
             else if (ext == ".qcnf" || ext == ".qdimacs") {
                 std::cerr << "Detected QBF, using QBF hash" << std::endl;
-                std::cout << PQBF::gbdhash(filename.c_str()) << std::endl;
+                std::cout << cache.fetch(filename.c_str(), "pqbf.gbdhash", [&] { return PQBF::gbdhash(filename.c_str()); }) << std::endl;
             }
             else if (ext == ".wcnf") {
                 std::cerr << "Detected WCNF, using WCNF hash" << std::endl;
-                std::cout << WCNF::gbdhash(filename.c_str()) << std::endl;
+                std::cout << cache.fetch(filename.c_str(), "wcnf.gbdhash", [&] { return WCNF::gbdhash(filename.c_str()); }) << std::endl;
+            }
+        } else if (toolname == "gbdhash" && batch) {
+            std::vector<std::string> files;
+            std::ifstream list;
+            if (filename != "-") {
+                list.open(filename);
+                if (!list) {
+                    std::cerr << "Error opening file list: " << filename << std::endl;
+                    return 1;
+                }
+            }
+            std::istream& in = filename == "-" ? std::cin : list;
+            std::string line;
+            while (std::getline(in, line)) {
+                if (!line.empty()) files.push_back(line);
+            }
+            std::vector<std::string> hashes(files.size());
+            std::vector<std::string> missing;
+            for (unsigned i = 0; i < files.size(); ++i) {
+                if (!cache.get(files[i].c_str(), "cnf.gbdhash", &hashes[i])) missing.push_back(files[i]);
+            }
+            std::vector<std::string> computed = CNF::gbdhash_batch(missing);
+            for (unsigned i = 0, j = 0; i < files.size(); ++i) {
+                if (hashes[i].empty()) {
+                    hashes[i] = computed[j++];
+                    if (hashes[i].empty()) {
+                        std::cerr << "Error parsing file: " << files[i] << std::endl;
+                        continue;
+                    }
+                    cache.put(files[i].c_str(), "cnf.gbdhash", hashes[i]);
+                }
+                std::cout << hashes[i] << " " << files[i] << std::endl;
             }
         } else if (toolname == "gbdhash") {
-            std::cout << CNF::gbdhash(filename.c_str()) << std::endl;
+            std::cout << cache.fetch(filename.c_str(), "cnf.gbdhash", [&] { return CNF::gbdhash(filename.c_str()); }) << std::endl;
         } else if (toolname == "isohash") {
-            std::string ext = std::filesystem::path(filename).extension();
-            if (ext == ".xz" || ext == ".lzma" || ext == ".bz2" || ext == ".gz") {
-                ext = std::filesystem::path(filename).stem().extension();
-            }
+            std::string ext = format_extension(filename);
             if (ext == ".cnf") {
                 std::cerr << "Detected CNF, using CNF isohash" << std::endl;
-                std::cout << CNF::isohash(filename.c_str()) << std::endl;
+                unsigned n_threads = argparse.is_used("threads") ? std::max(0, argparse.get<int>("threads")) : 1;
+                std::cout << cache.fetch(filename.c_str(), "cnf.isohash", [&] { return CNF::isohash(filename.c_str(), n_threads); }) << std::endl;
             } else if (ext == ".wcnf") {
                 std::cerr << "Detected WCNF, using WCNF isohash" << std::endl;
-                std::cout << WCNF::isohash(filename.c_str()) << std::endl;
+                std::cout << cache.fetch(filename.c_str(), "wcnf.isohash", [&] { return WCNF::isohash(filename.c_str()); }) << std::endl;
             }
+        } else if (toolname == "ingest") {
+            std::string hash, isohash;
+            std::vector<double> record;
+            CNF::SinglePass stats(filename.c_str());
+            if (!cache.get(filename.c_str(), "cnf.gbdhash", &hash) || !cache.get(filename.c_str(), "cnf.isohash", &isohash)
+                    || !cache.get(filename.c_str(), "cnf.base_features", &record)) {
+                stats.extract();
+                hash = stats.getGBDHash();
+                isohash = stats.getIsoHash();
+                record = stats.getFeatures();
+                cache.put(filename.c_str(), "cnf.gbdhash", hash);
+                cache.put(filename.c_str(), "cnf.isohash", isohash);
+                cache.put(filename.c_str(), "cnf.base_features", record);
+            }
+            std::cout << "gbdhash=" << hash << std::endl;
+            std::cout << "isohash=" << isohash << std::endl;
+            print_record(stats.getNames(), record);
         } else if (toolname == "opbhash") {
-            std::cout << OPB::gbdhash(filename.c_str()) << std::endl;
+            std::cout << cache.fetch(filename.c_str(), "opb.gbdhash", [&] { return OPB::gbdhash(filename.c_str()); }) << std::endl;
         } else if (toolname == "pqbfhash") {
-            std::cout << PQBF::gbdhash(filename.c_str()) << std::endl;
+            std::cout << cache.fetch(filename.c_str(), "pqbf.gbdhash", [&] { return PQBF::gbdhash(filename.c_str()); }) << std::endl;
         } else if (toolname == "normalize") {
             std::cerr << "Normalizing " << filename << std::endl;
-            normalize(filename.c_str());
+            normalize(filename.c_str(), output.c_str(), compression);
         } else if (toolname == "checksani") {
             if (!check_sanitized(filename.c_str())) {
                 std::cerr << filename << " needs sanitization" << std::endl;
             }
         } else if (toolname == "sanitize") {
-            sanitize(filename.c_str());
+            sanitize(filename.c_str(), output.c_str(), compression, argparse.is_used("threads") ? std::max(0, argparse.get<int>("threads")) : 1);
         } else if (toolname == "cnf2kis") {
             std::cerr << "Generating Independent Set Problem " << filename << std::endl;
             IndependentSetFromCNF gen(filename.c_str());
-            gen.generate_independent_set_problem(output == "-" ? nullptr : output.c_str());
+            gen.generate_independent_set_problem(output == "-" ? nullptr : output.c_str(), compression, std::max(0, argparse.get<int>("threads")),
+                graph_format(argparse.get("graph-format"), output));
         } else if (toolname == "extract") {
-            std::string ext = std::filesystem::path(filename).extension();
-            if (ext == ".xz" || ext == ".lzma" || ext == ".bz2" || ext == ".gz") {
-                ext = std::filesystem::path(filename).stem().extension();
-            }
+            std::string ext = format_extension(filename);
             if (ext == ".cnf") {
                 std::cerr << "Detected CNF, extracting CNF base features" << std::endl;
                 CNF::BaseFeatures stats(filename.c_str());
-                stats.extract();
-                std::vector<double> record = stats.getFeatures();
-                std::vector<std::string> names = stats.getNames();
-                for (unsigned i = 0; i < record.size(); i++) {
-                    std::cout << names[i] << "=" << record[i] << std::endl;
-                }
+                std::vector<double> record = cache.fetch(filename.c_str(), "cnf.base_features", [&] {
+                    stats.extract();
+                    return stats.getFeatures();
+                });
+                print_record(stats.getNames(), record);
             } else if (ext == ".wcnf") {
                 std::cerr << "Detected WCNF, extracting WCNF base features" << std::endl;
                 WCNF::BaseFeatures stats(filename.c_str());
-                stats.extract();
-                std::vector<double> record = stats.getFeatures();
-                std::vector<std::string> names = stats.getNames();
-                for (unsigned i = 0; i < record.size(); i++) {
-                    std::cout << names[i] << "=" << record[i] << std::endl;
-                }
+                std::vector<double> record = cache.fetch(filename.c_str(), "wcnf.base_features", [&] {
+                    stats.extract();
+                    return stats.getFeatures();
+                });
+                print_record(stats.getNames(), record);
             } else if (ext == ".opb") {
                 std::cerr << "Detected OPB, extracting OPB base features" << std::endl;
                 OPB::BaseFeatures stats(filename.c_str());
-                stats.extract();
-                std::vector<double> record = stats.getFeatures();
-                std::vector<std::string> names = stats.getNames();
-                for (unsigned i = 0; i < record.size(); i++) {
-                    std::cout << names[i] << "=" << record[i] << std::endl;
-                }
+                std::vector<double> record = cache.fetch(filename.c_str(), "opb.base_features", [&] {
+                    stats.extract();
+                    return stats.getFeatures();
+                });
+                print_record(stats.getNames(), record);
             }
         } else if (toolname == "gates") {
-            CNFGateFeatures stats(filename.c_str());
+            CNFGateFeatures stats(filename.c_str(), argparse.is_used("threads") ? std::max(0, argparse.get<int>("threads")) : 1);
             stats.extract();
             std::vector<double> record = stats.getFeatures();
-            std::vector<std::string> names = stats.getNames();
-            for (unsigned i = 0; i < record.size(); i++) {
-                std::cout << names[i] << "=" << record[i] << std::endl;
-            }
+            print_record(stats.getNames(), record);
         } else if (toolname == "test") {
             std::cout << "Testing something ... " << std::endl;
             StreamCompressor cmpr(filename.c_str(), 100);
             for (int i = 0; i < 10; i++)
                 cmpr.write("0123456789", 10);
         }
+        if (profile) {
+            std::cerr << Profiler::instance().to_json() << std::endl;
+        }
     }
     catch (std::bad_alloc& e) {
         std::cerr << "Memory Limit Exceeded" << std::endl;
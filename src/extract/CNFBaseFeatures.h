@@ -8,7 +8,9 @@
 #define BASE_FEATURES_H_
 
 #include "IExtractor.h"
+#include "src/util/MemoryBudget.h"
 #include "src/util/StreamBuffer.h"
+#include "src/util/Profiler.h"
 #include "src/extract/Util.h"
 #include <array>
 
@@ -42,6 +44,16 @@ class BaseFeatures1 : public IExtractor {
     // Literal Occurrences
     std::vector<unsigned> literal_occurrences;
 
+    // Connected Components
+    UnionFind uf;
+
+    MemoryAccount memory;
+
+    // charge the per-variable and per-clause vectors after they grew
+    void account_memory() {
+        memory.set(heap_bytes(variable_horn) + heap_bytes(variable_inv_horn) + heap_bytes(balance_clause) + heap_bytes(literal_occurrences));
+    }
+
   public:
     BaseFeatures1(const char* filename) : filename_(filename), features(), names() { 
         clause_sizes.fill(0);
@@ -58,54 +70,68 @@ class BaseFeatures1 : public IExtractor {
 
     virtual void extract() {
         StreamBuffer in(filename_);
-        UnionFind uf;
         Cl clause;
+        LapTimer laps({ "tokenize", "aggregate" });
         while (in.readClause(clause)) {
-            ++n_clauses;            
-            ++clause_sizes[std::min(clause.size(), 10UL)];
-            // +1 for 0 at EOL and +1 for linebreak
-            bytes += 2;
-
-            uf.insert(clause);
+            laps.lap(0);
+            add_clause(clause);
+            laps.lap(1);
+        }
+        laps.lap(0);
+        finalize();
+    }
 
-            unsigned n_neg = 0;
-            for (Lit lit : clause) {
-                // +1 for whitespace after variables
-                bytes += lit.sign() + numDigits(lit.var()) + 1;
-                // resize vectors if necessary
-                if (lit.var() > n_vars) {
-                    n_vars = lit.var();
-                    variable_horn.resize(n_vars + 1);
-                    variable_inv_horn.resize(n_vars + 1);
-                    literal_occurrences.resize(2 * n_vars + 2);
-                }
-                // count negative literals
-                if (lit.sign()) ++n_neg;
-                ++literal_occurrences[lit];
+    void add_clause(const Cl& clause) {
+        ++n_clauses;            
+        ++clause_sizes[std::min(clause.size(), 10UL)];
+        // +1 for 0 at EOL and +1 for linebreak
+        bytes += 2;
+
+        uf.insert(clause);
+
+        unsigned n_neg = 0;
+        for (Lit lit : clause) {
+            // +1 for whitespace after variables
+            bytes += lit.sign() + numDigits(lit.var()) + 1;
+            // resize vectors if necessary
+            if (lit.var() > n_vars) {
+                n_vars = lit.var();
+                variable_horn.resize(n_vars + 1);
+                variable_inv_horn.resize(n_vars + 1);
+                literal_occurrences.resize(2 * n_vars + 2);
+                account_memory();
             }
+            // count negative literals
+            if (lit.sign()) ++n_neg;
+            ++literal_occurrences[lit];
+        }
 
-            // horn statistics
-            unsigned n_pos = clause.size() - n_neg;
-            if (n_neg <= 1) {
-                if (n_neg == 0) ++positive;
-                ++horn;
-                for (Lit lit : clause) {
-                    ++variable_horn[lit.var()];
-                }
+        // horn statistics
+        unsigned n_pos = clause.size() - n_neg;
+        if (n_neg <= 1) {
+            if (n_neg == 0) ++positive;
+            ++horn;
+            for (Lit lit : clause) {
+                ++variable_horn[lit.var()];
             }
-            if (n_pos <= 1) {
-                if (n_pos == 0) ++negative;
-                ++inv_horn;
-                for (Lit lit : clause) {
-                    ++variable_inv_horn[lit.var()];
-                }
+        }
+        if (n_pos <= 1) {
+            if (n_pos == 0) ++negative;
+            ++inv_horn;
+            for (Lit lit : clause) {
+                ++variable_inv_horn[lit.var()];
             }
+        }
 
-            // balance of positive and negative literals per clause
-            if (clause.size() > 0) {
-                balance_clause.push_back((double)std::min(n_pos, n_neg) / (double)std::max(n_pos, n_neg));
-            }
+        // balance of positive and negative literals per clause
+        if (clause.size() > 0) {
+            balance_clause.push_back((double)std::min(n_pos, n_neg) / (double)std::max(n_pos, n_neg));
+            if (balance_clause.size() == balance_clause.capacity()) account_memory();
         }
+    }
+
+    void finalize() {
+        ScopedTimer timer("statistics");
         // subtract last linebreak
         bytes -= 1;
 
@@ -160,6 +186,13 @@ class BaseFeatures2 : public IExtractor {
     // CG Degree Distribution
     std::vector<unsigned> clause_degree;
 
+    MemoryAccount memory;
+
+    // charge the per-variable and per-clause vectors after they grew
+    void account_memory() {
+        memory.set(heap_bytes(vcg_cdegree) + heap_bytes(vcg_vdegree) + heap_bytes(vg_degree) + heap_bytes(clause_degree));
+    }
+
   public:
     BaseFeatures2(const char* filename) : filename_(filename), features(), names() { 
         names.insert(names.end(), { "vcg_vdegree_mean", "vcg_vdegree_variance", "vcg_vdegree_min", "vcg_vdegree_max", "vcg_vdegree_entropy" });
@@ -173,36 +206,56 @@ class BaseFeatures2 : public IExtractor {
         StreamBuffer in(filename_);
 
         Cl clause;
+        LapTimer laps({ "tokenize", "aggregate" });
         while (in.readClause(clause)) {
-            vcg_cdegree.push_back(clause.size());
-
-            for (Lit lit : clause) {
-                // resize vectors if necessary
-                if (lit.var() > n_vars) {
-                    n_vars = lit.var();
-                    vcg_vdegree.resize(n_vars + 1);
-                    vg_degree.resize(n_vars + 1);
-                }
-                // count variable occurrences
-                ++vcg_vdegree[lit.var()];
-                vg_degree[lit.var()] += clause.size();
-            }
+            laps.lap(0);
+            add_clause(clause);
+            laps.lap(1);
         }
 
         // clause graph features
         StreamBuffer in2(filename_);
         while (in2.readClause(clause)) {
-            unsigned degree = 0;
-            for (Lit lit : clause) {
-                degree += vcg_vdegree[lit.var()];
-            }
-            clause_degree.push_back(degree);
+            laps.lap(0);
+            add_clause_degree(clause);
+            laps.lap(1);
         }
+        laps.lap(0);
 
         load_feature_records();
     }
 
+    // first pass: variable-clause graph and variable graph degrees
+    void add_clause(const Cl& clause) {
+        vcg_cdegree.push_back(clause.size());
+        if (vcg_cdegree.size() == vcg_cdegree.capacity()) account_memory();
+
+        for (Lit lit : clause) {
+            // resize vectors if necessary
+            if (lit.var() > n_vars) {
+                n_vars = lit.var();
+                vcg_vdegree.resize(n_vars + 1);
+                vg_degree.resize(n_vars + 1);
+                account_memory();
+            }
+            // count variable occurrences
+            ++vcg_vdegree[lit.var()];
+            vg_degree[lit.var()] += clause.size();
+        }
+    }
+
+    // second pass: clause graph degrees, requires all clauses of the first pass
+    void add_clause_degree(const Cl& clause) {
+        unsigned degree = 0;
+        for (Lit lit : clause) {
+            degree += vcg_vdegree[lit.var()];
+        }
+        clause_degree.push_back(degree);
+        if (clause_degree.size() == clause_degree.capacity()) account_memory();
+    }
+
     void load_feature_records() {
+        ScopedTimer timer("statistics");
         push_distribution(features, vcg_vdegree);
         push_distribution(features, vcg_cdegree);
         push_distribution(features, vg_degree);
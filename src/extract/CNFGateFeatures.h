@@ -22,13 +22,17 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <math.h>
 
+#include <climits>
 #include <vector>
 #include <iostream>
 #include <algorithm>
 #include <numeric>
 #include <string>
 
+#include "src/util/Cancellation.h"
+#include "src/util/Profiler.h"
 #include "src/util/SolverTypes.h"
+#include "src/util/WorkQueue.h"
 
 #include "src/extract/IExtractor.h"
 
@@ -40,6 +44,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 class CNFGateFeatures : public IExtractor {
     const char* filename_;
+    unsigned n_threads_;
     std::vector<double> features;
     std::vector<std::string> names;
 
@@ -52,7 +57,11 @@ class CNFGateFeatures : public IExtractor {
     std::vector<unsigned> levels_equiv, levels_full;
 
   public:
-    CNFGateFeatures(const char* filename) : filename_(filename), features(), names() { 
+    /**
+     * @param filename
+     * @param n_threads number of threads analyzing connected components in parallel, 1: serial (default), 0: one per core (up to 8)
+     */
+    CNFGateFeatures(const char* filename, unsigned n_threads = 1) : filename_(filename), n_threads_(n_threads), features(), names() {
         names.insert(names.end(), { "n_vars", "n_gates", "n_roots" });
         names.insert(names.end(), { "n_none", "n_generic", "n_mono" });
         names.insert(names.end(), { "n_and", "n_or", "n_triv", "n_equiv", "n_full" });
@@ -70,10 +79,18 @@ class CNFGateFeatures : public IExtractor {
     virtual ~CNFGateFeatures() { }
 
     virtual void extract() {
+        LapTimer laps({ "gates.parse", "gates.bfs", "gates.levels", "statistics" });
         CNFFormula formula(filename_);
+        laps.lap(0);
         GateAnalyzer analyzer(formula, true, true, formula.nVars() / 3, false);
-        analyzer.analyze();
+        unsigned n_threads = n_threads_ > 0 ? n_threads_ : num_workers();
+        if (n_threads > 1) {
+            analyzer.analyze(components(formula), n_threads);
+        } else {
+            analyzer.analyze();
+        }
         GateFormula gates = analyzer.getGateFormula();
+        laps.lap(1);
         n_vars = formula.nVars();
         n_gates = gates.nGates();
         n_roots = gates.nRoots();
@@ -85,6 +102,7 @@ class CNFGateFeatures : public IExtractor {
         while (!current.empty()) {
             ++level;
             for (Lit lit : current) {
+                cancellation_point();
                 const Gate& gate = gates.getGate(lit);
                 if (gate.isDefined() && levels[lit.var()] == 0) {
                     levels[lit.var()] = level;
@@ -94,6 +112,7 @@ class CNFGateFeatures : public IExtractor {
             current.clear();
             current.swap(next);
         }
+        laps.lap(2);
         // Gate Type Counts and Levels
         for (unsigned i = 1; i <= n_vars; i++) {
             const Gate& gate = gates.getGate(Lit(Var(i)));
@@ -133,6 +152,32 @@ class CNFGateFeatures : public IExtractor {
             }
         }
         load_feature_records();
+        laps.lap(3);
+    }
+
+    /**
+     * @brief variables of the connected components of formula, in ascending order
+     */
+    static std::vector<std::vector<Var>> components(const CNFFormula& formula) {
+        UnionFind uf;
+        std::vector<char> occurs(formula.nVars() + 1, false);
+        for (Cl* clause : formula) {
+            if (clause->empty()) continue;
+            uf.insert(*clause);
+            for (Lit lit : *clause) occurs[lit.var()] = true;
+        }
+        std::vector<std::vector<Var>> result;
+        std::vector<unsigned> component(formula.nVars() + 1, UINT_MAX);
+        for (unsigned i = 1; i <= formula.nVars(); ++i) {
+            if (!occurs[i]) continue;
+            Var root = uf.find(Var(i));
+            if (component[root] == UINT_MAX) {
+                component[root] = result.size();
+                result.emplace_back();
+            }
+            result[component[root]].push_back(Var(i));
+        }
+        return result;
     }
 
     void load_feature_records() {
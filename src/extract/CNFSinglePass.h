@@ -0,0 +1,144 @@
+/**
+ * MIT License
+ *
+ * Copyrigth (c) 2024 Markus Iser
+ */
+
+#ifndef CNF_SINGLE_PASS_H_
+#define CNF_SINGLE_PASS_H_
+
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "IExtractor.h"
+#include "lib/md5/md5.h"
+#include "src/util/MemoryBudget.h"
+#include "src/util/StreamBuffer.h"
+#include "src/util/Profiler.h"
+#include "src/identify/ISOHash.h"
+#include "src/extract/CNFBaseFeatures.h"
+
+namespace CNF {
+
+/**
+ * @brief Computes gbdhash, isohash and base features while parsing the instance only once.
+ * The token stream is fanned out to the md5 normalizer, the isohash degree counter and the base feature accumulators.
+ * Clause degrees of the base features require a second pass over all clauses,
+ * which is done over a compact in-memory copy of the literals instead of re-reading the file.
+ */
+class SinglePass : public IExtractor {
+    const char* filename_;
+    std::vector<double> features;
+    std::vector<std::string> names;
+
+    std::string gbdhash_;
+    std::string isohash_;
+
+    MemoryAccount memory;
+
+    // charge the per-variable and per-clause vectors of extract() after they grew
+    void account_memory(const std::vector<IsoNode>& degrees, const std::vector<Lit>& literals, const std::vector<unsigned>& sizes) {
+        memory.set(heap_bytes(degrees) + heap_bytes(literals) + heap_bytes(sizes));
+    }
+
+  public:
+    SinglePass(const char* filename) : filename_(filename), features(), names(), memory() {
+        BaseFeatures baseFeatures(filename_);
+        names = baseFeatures.getNames();
+    }
+
+    virtual ~SinglePass() { }
+
+    virtual void extract() {
+        StreamBuffer in(filename_);
+        MD5 md5;
+        std::vector<IsoNode> degrees;
+        BaseFeatures1 baseFeatures1(filename_);
+        BaseFeatures2 baseFeatures2(filename_);
+        std::vector<Lit> literals;  // all clauses, for the second pass of baseFeatures2
+        std::vector<unsigned> sizes;
+
+        Cl clause;
+        std::string plit;
+        bool notfirst = false;
+        LapTimer laps({ "tokenize", "aggregate" });
+        while (in.skipWhitespace()) {
+            if (*in == 'p' || *in == 'c') {
+                if (!in.skipLine()) break;
+                continue;
+            }
+            if (notfirst) md5.consume(" ", 1);
+            clause.clear();
+            while (in.readNumber(&plit)) {
+                if (plit == "0") break;
+                md5.consume(plit.c_str(), plit.length());
+                md5.consume(" ", 1);
+                long lit = std::strtol(plit.c_str(), nullptr, 10);
+                if (std::abs(lit) > std::numeric_limits<int32_t>::max()) {
+                    throw ParserException(std::string(filename_) + ": number out of int32 range");
+                }
+                if (lit == 0) continue;
+                unsigned var = std::abs(lit);
+                if (var > degrees.size()) {
+                    degrees.resize(var);
+                    account_memory(degrees, literals, sizes);
+                }
+                if (lit < 0) ++degrees[var - 1].neg;
+                else ++degrees[var - 1].pos;
+                clause.push_back(Lit(var, lit < 0));
+            }
+            md5.consume("0", 1);
+            notfirst = true;
+            laps.lap(0);
+
+            baseFeatures1.add_clause(clause);
+            baseFeatures2.add_clause(clause);
+            size_t capacity = literals.capacity() + sizes.capacity();
+            literals.insert(literals.end(), clause.begin(), clause.end());
+            sizes.push_back(clause.size());
+            if (literals.capacity() + sizes.capacity() != capacity) account_memory(degrees, literals, sizes);
+            laps.lap(1);
+        }
+        laps.lap(0);
+        gbdhash_ = md5.produce();
+        isohash_ = hash_degree_sequence(degrees);
+
+        baseFeatures1.finalize();
+        auto it = literals.begin();
+        for (unsigned size : sizes) {
+            clause.assign(it, it + size);
+            baseFeatures2.add_clause_degree(clause);
+            it += size;
+        }
+        laps.lap(1);
+        baseFeatures2.load_feature_records();
+
+        std::vector<double> feat1 = baseFeatures1.getFeatures();
+        std::vector<double> feat2 = baseFeatures2.getFeatures();
+        features.insert(features.end(), feat1.begin(), feat1.end());
+        features.insert(features.end(), feat2.begin(), feat2.end());
+        memory.set(0);
+    }
+
+    std::string getGBDHash() const {
+        return gbdhash_;
+    }
+
+    std::string getIsoHash() const {
+        return isohash_;
+    }
+
+    virtual std::vector<double> getFeatures() const {
+        return features;
+    }
+
+    virtual std::vector<std::string> getNames() const {
+        return names;
+    }
+};
+
+}; // namespace CNF
+
+#endif // CNF_SINGLE_PASS_H_
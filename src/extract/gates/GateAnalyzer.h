@@ -22,15 +22,22 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <cstdlib>
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <cmath>
+#include <thread>
 #include <vector>
 #include <unordered_set>
 #include <climits>
 
 #include "lib/ipasir.h"
 
+#include "src/util/Cancellation.h"
 #include "src/util/CNFFormula.h"
+#include "src/util/Profiler.h"
 
 #include "src/extract/gates/GateFormula.h"
 #include "src/extract/gates/BlockList.h"
@@ -56,15 +63,30 @@ class GateAnalyzer {
     unsigned max_ = 1;
     unsigned verbose_ = 0;
 
+    // parallel analysis of connected components
+    std::vector<unsigned> component_;  // component of each variable
+    std::vector<unsigned> position_;  // of each variable in its component, solvers of components use these as names
+    std::vector<void*> solvers_;  // one solver per component, created on demand
+    std::mutex mutex_;  // guards gate_formula
+
+    struct Round {  // one round of root selection in one component
+        Lit root;  // literal whose clauses were selected as roots
+        For roots;
+        std::vector<Lit> outputs;  // of the gates recognized in this round
+    };
+
  public:
     GateAnalyzer(const CNFFormula& formula, bool patterns_, bool semantic_, unsigned max, unsigned verbose = 0) :
      formula_(formula), gate_formula(formula.nVars(), verbose), index(formula),
      patterns(patterns_), semantic(semantic_), max_(max), verbose_(verbose) {
-        if (semantic) S = ipasir_init();
+        if (semantic) S = new_solver();
     }
 
     ~GateAnalyzer() {
         if (semantic) ipasir_release(S);
+        for (void* solver : solvers_) {
+            if (solver != nullptr) ipasir_release(solver);
+        }
     }
 
     GateFormula getGateFormula() const {
@@ -75,9 +97,11 @@ class GateAnalyzer {
      * @brief Starting-point gate analysis: iterative root selection
      */
     void analyze() {
-        std::vector<Cl*> root_clauses = index.estimateRoots();
-
-        for (unsigned count = 0; count < max_ && !root_clauses.empty(); count++) {
+        for (unsigned count = 0; count < max_; count++) {
+            check_cancellation();
+            // select roots only for rounds which run, such that the clauses of further roots remain
+            std::vector<Cl*> root_clauses = index.estimateRoots();
+            if (root_clauses.empty()) break;
             std::vector<Lit> candidates;
             for (Cl* clause : root_clauses) {
                 gate_formula.addRoot(clause);
@@ -85,8 +109,6 @@ class GateAnalyzer {
             }
 
             gate_recognition(candidates);
-
-            root_clauses = index.estimateRoots();
         }
 
         std::unordered_set<Cl*> remainder;
@@ -96,20 +118,221 @@ class GateAnalyzer {
         gate_formula.remainder.insert(gate_formula.remainder.end(), remainder.begin(), remainder.end());
     }
 
+    /**
+     * @brief Gate analysis of the connected components of the formula on several threads, with the same result as analyze()
+     * Unit clauses are selected as roots of all components at once, as in analyze(). The following rounds of root selection
+     * run per component, each with its own solver, and are merged in the order in which analyze() selects them.
+     * The occurrence list and the gate formula are shared, as components do not share variables.
+     * @param components variables of each component in ascending order
+     * @param n_threads number of threads
+     */
+    void analyze(const std::vector<std::vector<Var>>& components, unsigned n_threads) {
+        n_threads = std::min<size_t>(n_threads, components.size());
+        if (n_threads < 2 || max_ == 0) {
+            analyze();
+            return;
+        }
+        component_.resize(formula_.nVars() + 1, 0);
+        position_.resize(formula_.nVars() + 1, 0);
+        for (unsigned c = 0; c < components.size(); ++c) {
+            for (unsigned i = 0; i < components[c].size(); ++i) {
+                component_[components[c][i]] = c;
+                position_[components[c][i]] = i + 1;
+            }
+        }
+        solvers_.resize(components.size(), nullptr);
+
+        unsigned budget = max_;
+        For units = index.extractUnits();
+        if (!units.empty()) {
+            std::vector<Lit> candidates;
+            for (Cl* clause : units) {
+                gate_formula.addRoot(clause);
+                candidates.insert(candidates.end(), clause->begin(), clause->end());
+            }
+            gate_recognition(candidates);
+            --budget;
+        }
+
+        // larger components first for better load balance
+        std::vector<unsigned> order(components.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&components] (unsigned a, unsigned b) {
+            return components[a].size() > components[b].size();
+        });
+        std::vector<std::vector<Round>> rounds(components.size());
+        std::atomic<size_t> next(0);
+        std::atomic<bool> failed(false);
+        std::vector<std::exception_ptr> errors(n_threads);
+        CancellationToken* token = current_cancellation_token();
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < n_threads; ++i) {
+            workers.emplace_back([&, i] {
+                CancellationScope scope(token);
+                try {
+                    for (size_t k = next++; k < order.size() && !failed; k = next++) {
+                        unsigned c = order[k];
+                        analyze_component(components[c], budget, rounds[c]);
+                        if (solvers_[c] != nullptr) {
+                            ipasir_release(solvers_[c]);
+                            solvers_[c] = nullptr;
+                        }
+                    }
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                    failed = true;
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        for (std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+        merge_rounds(components, budget, rounds);
+    }
+
  private:
+    static int terminate(void* token) {
+        return static_cast<CancellationToken*>(token)->expired();
+    }
+
+    void* new_solver() {
+        void* solver = ipasir_init();
+        CancellationToken* token = current_cancellation_token();
+        if (token != nullptr) ipasir_set_terminate(solver, token, terminate);
+        return solver;
+    }
+
+    // solver of the component of var in parallel analysis
+    void* solver_of(Var var) {
+        if (component_.empty()) return S;
+        void*& solver = solvers_[component_[var]];
+        if (solver == nullptr) solver = new_solver();
+        return solver;
+    }
+
+    // literal in the solver of its component
+    int dimacs(Lit lit) {
+        if (position_.empty()) return lit.toDimacs();
+        return lit.sign() ? -static_cast<int>(position_[lit.var()]) : position_[lit.var()];
+    }
+
+    /**
+     * @brief Rounds of root selection in one component, as in analyze(): the clauses of its largest literal which still
+     * has clauses become the roots of the next round
+     */
+    void analyze_component(const std::vector<Var>& vars, unsigned budget, std::vector<Round>& rounds) {
+        size_t pos = 0, end = 2 * vars.size();
+        auto literal = [&vars] (size_t i) {  // literals in descending order
+            return Lit(vars[vars.size() - 1 - i / 2], i % 2 == 0);
+        };
+        while (rounds.size() < budget) {
+            check_cancellation();
+            while (pos < end && index[literal(pos)].empty()) ++pos;
+            if (pos == end) break;
+            Round round { literal(pos), index.extractRoots(literal(pos)), {} };
+            std::vector<Lit> candidates;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (Cl* clause : round.roots) gate_formula.addRoot(clause);
+            }
+            for (Cl* clause : round.roots) {
+                candidates.insert(candidates.end(), clause->begin(), clause->end());
+            }
+            gate_recognition(candidates, &round.outputs);
+            rounds.push_back(std::move(round));
+        }
+    }
+
+    /**
+     * @brief Keep the rounds which analyze() would run, i.e., up to budget rounds in descending order of their root literals,
+     * and undo the others
+     */
+    void merge_rounds(const std::vector<std::vector<Var>>& components, unsigned budget, std::vector<std::vector<Round>>& rounds) {
+        std::vector<std::pair<Lit, unsigned>> order;
+        for (unsigned c = 0; c < rounds.size(); ++c) {
+            for (const Round& round : rounds[c]) order.emplace_back(round.root, c);
+        }
+        std::sort(order.begin(), order.end(), [] (const std::pair<Lit, unsigned>& a, const std::pair<Lit, unsigned>& b) {
+            return b.first < a.first;
+        });
+        if (order.size() > budget) order.resize(budget);
+
+        // roots in order of selection, starting after the unit clauses
+        size_t n_roots = gate_formula.roots.size();
+        for (const std::vector<Round>& component : rounds) {
+            for (const Round& round : component) n_roots -= round.roots.size();
+        }
+        gate_formula.roots.resize(n_roots);
+        std::vector<unsigned> kept(rounds.size(), 0);
+        for (const std::pair<Lit, unsigned>& selected : order) {
+            const Round& round = rounds[selected.second][kept[selected.second]++];
+            gate_formula.roots.insert(gate_formula.roots.end(), round.roots.begin(), round.roots.end());
+        }
+
+        // clauses of undone rounds remain
+        std::unordered_set<Cl*> remainder;
+        std::vector<char> undone(rounds.size(), false);
+        for (unsigned c = 0; c < rounds.size(); ++c) {
+            for (unsigned r = kept[c]; r < rounds[c].size(); ++r) {
+                remainder.insert(rounds[c][r].roots.begin(), rounds[c][r].roots.end());
+                for (Lit output : rounds[c][r].outputs) {
+                    Gate& gate = gate_formula.getGate(output);
+                    remainder.insert(gate.fwd.begin(), gate.fwd.end());
+                    remainder.insert(gate.bwd.begin(), gate.bwd.end());
+                    gate = Gate();
+                }
+                undone[c] = true;
+            }
+        }
+        // input marks of components with undone rounds from their remaining roots and gates
+        for (unsigned c = 0; c < rounds.size(); ++c) {
+            if (!undone[c]) continue;
+            for (Var var : components[c]) {
+                for (Lit lit : { Lit(var, false), Lit(var, true) }) {
+                    gate_formula.inputs[lit] = false;
+                    gate_formula.direct[lit] = false;
+                }
+            }
+        }
+        for (Cl* root : gate_formula.roots) {
+            for (Lit lit : *root) {
+                if (undone[component_[lit.var()]]) gate_formula.inputs[lit] = true;
+            }
+        }
+        for (unsigned c = 0; c < rounds.size(); ++c) {
+            if (!undone[c]) continue;
+            for (Var var : components[c]) {
+                const Gate& gate = gate_formula.getGate(Lit(var));
+                for (Lit lit : gate.inp) {
+                    gate_formula.inputs[lit] = true;
+                    gate_formula.direct[lit] = true;
+                    if (gate.notMono) gate_formula.inputs[~lit] = true;
+                }
+            }
+        }
+
+        for (size_t lit = 0; lit < index.size(); lit++) {
+            remainder.insert(index[lit].begin(), index[lit].end());
+        }
+        gate_formula.remainder.insert(gate_formula.remainder.end(), remainder.begin(), remainder.end());
+    }
+
     /**
      * @brief Start hierarchical gate recognition with given root literals
      * 
      * @param roots 
      */
-    void gate_recognition(std::vector<Lit> roots) {
+    void gate_recognition(std::vector<Lit> roots, std::vector<Lit>* outputs = nullptr) {
         // std::cerr << "c Starting gate-recognition with roots: " << roots << std::endl;
         std::vector<Lit> candidates { roots.begin(), roots.end() };
         std::unordered_set<Lit> frontier;
         while (!candidates.empty()) {  // breadth_ first search is important here
             // std::cout << "Number of Candidates: " << candidates.size() << std::endl;
             for (Lit candidate : candidates) {
+                cancellation_point(1 + index[candidate].size() + index[~candidate].size());
                 if (checkAddGate(candidate)) {
+                    if (outputs != nullptr) outputs->push_back(candidate);
                     Gate& gate = gate_formula.getGate(candidate);
                     index.remove(gate.fwd);
                     index.remove(gate.bwd);
@@ -191,6 +414,7 @@ class GateAnalyzer {
             }
 
             if (type != NONE) {
+                std::lock_guard<std::mutex> lock(mutex_);
                 gate_formula.addGate(type, out, index[~out], index[out], getInputLiterals(~out, index[~out]));
                 return true;
             }
@@ -224,6 +448,8 @@ class GateAnalyzer {
     }
 
     GateType fSemantic(Lit o, const For& fwd, const For& bwd) {
+        ScopedTimer timer("gates.semantic");
+        void* solver = solver_of(o.var());
         // std::cout << "Semantic check for " << fwd.size() + bwd.size() << " clauses" << std::endl;
         // std::cout << fwd << std::endl;
         // std::cout << bwd << std::endl;
@@ -231,17 +457,20 @@ class GateAnalyzer {
             for (Cl* cl : f) {
                 for (Lit lit : *cl) {
                     if (lit.var() != o.var()) {
-                        ipasir_add(S, lit.toDimacs());
+                        ipasir_add(solver, dimacs(lit));
                     } else {
-                        ipasir_add(S, lit.positive().toDimacs());
+                        ipasir_add(solver, dimacs(lit.positive()));
                     }
                 }
-                ipasir_add(S, 0);
+                ipasir_add(solver, 0);
             }
         }
-        ipasir_assume(S, o.negative().toDimacs());
-        int result = ipasir_solve(S);
-        ipasir_add(S, o.positive().toDimacs());
+        ipasir_assume(solver, dimacs(o.negative()));
+        int result = ipasir_solve(solver);
+        if (result == 0) check_cancellation();
+        // unit clause which satisfies the clauses of this check in later checks
+        ipasir_add(solver, dimacs(o.positive()));
+        ipasir_add(solver, 0);
         return result == 20 ? GENERIC : NONE;
     }
 
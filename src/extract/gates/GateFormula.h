@@ -26,6 +26,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <set>
 
 #include "src/util/CNFFormula.h"
+#include "src/util/MemoryBudget.h"
 #include "src/util/Stamp.h"
 
 
@@ -62,13 +63,15 @@ class GateFormula {
     For remainder;  // stores clauses remaining outside of recognized gate-structure
     bool artificialRoot;  // top-level unit-clause that can be generated by normalizeRoots()
     unsigned verbose_;
+    MemoryAccount memory;
 
     explicit GateFormula(unsigned verbose) :
-     roots(), gates(), artificialRoot(false), verbose_(verbose)
+     roots(), gates(), artificialRoot(false), verbose_(verbose), memory()
     { }
 
     explicit GateFormula(unsigned nVars, unsigned verbose) :
-     roots(), gates(), artificialRoot(false), verbose_(verbose) {
+     roots(), gates(), artificialRoot(false), verbose_(verbose), memory() {
+        memory.charge(2 * (2 + 2*nVars) + (2 + nVars) * sizeof(Gate));
         inputs.resize(2 + 2*nVars, false);
         direct.resize(2 + 2*nVars, false);
         gates.resize(2 + nVars);
@@ -93,6 +96,7 @@ class GateFormula {
     }
 
     void addGate(GateType type, Lit o, For fwd, For bwd, std::vector<Lit> inp) {
+        memory.charge(heap_bytes(fwd) + heap_bytes(bwd) + heap_bytes(inp));
         Gate& gate = gates[o.var()];
         gate.type = type;
         gate.out = o;
@@ -26,6 +26,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <utility>
 
 #include "src/util/CNFFormula.h"
+#include "src/util/MemoryBudget.h"
 
 class OccurrenceList {
     const CNFFormula& problem;
@@ -33,6 +34,7 @@ class OccurrenceList {
     std::vector<For> index;
     std::vector<Cl*> unitc;
     Lit max_literal;
+    MemoryAccount memory;
 
 #define CLAUSES_ARE_SORTED
 #ifdef CLAUSES_ARE_SORTED
@@ -50,7 +52,10 @@ class OccurrenceList {
 #endif
 
  public:
-    explicit OccurrenceList(const CNFFormula& problem_) : problem(problem_), unitc(), max_literal(problem.nVars(), true) {
+    explicit OccurrenceList(const CNFFormula& problem_) : problem(problem_), unitc(), max_literal(problem.nVars(), true), memory() {
+        uint64_t occurrences = 0;
+        for (Cl* clause : problem_) occurrences += clause->size();
+        memory.charge((2 + 2 * problem.nVars()) * sizeof(For) + occurrences * sizeof(Cl*));
         index.resize(2 + 2 * problem.nVars());
 
         for (Cl* clause : problem_) {
@@ -112,13 +117,31 @@ class OccurrenceList {
                 --max_literal;
             }
             if (max_literal > 0) {
-                result.swap(index[max_literal]);
-                remove(result);
+                result = extractRoots(max_literal);
             }
         }
 
         return result;
     }
+
+    /**
+     * @brief unit clauses as roots
+     */
+    For extractUnits() {
+        For result {};
+        std::swap(result, unitc);
+        return result;
+    }
+
+    /**
+     * @brief clauses of the given literal as roots, removed from the index
+     */
+    For extractRoots(Lit lit) {
+        For result {};
+        result.swap(index[lit]);
+        remove(result);
+        return result;
+    }
 };
 
 #endif  // SRC_GATES_OCCURRENCELIST_H_
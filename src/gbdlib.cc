@@ -17,7 +17,9 @@ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  **************************************************************************************************/
 
+#include <algorithm>
 #include <cstdio>
+#include <memory>
 
 #include "Python.h"
 
@@ -26,8 +28,12 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include "src/util/ResourceLimits.h"
 #include "src/util/py_util.h"
+#include "src/util/ResultCache.h"
+#include "src/util/Profiler.h"
+#include "src/util/ArchiveReader.h"
 
 #include "src/extract/CNFBaseFeatures.h"
+#include "src/extract/CNFSinglePass.h"
 #include "src/extract/CNFGateFeatures.h"
 #include "src/extract/WCNFBaseFeatures.h"
 #include "src/extract/OPBBaseFeatures.h"
@@ -35,236 +41,319 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "src/transform/IndependentSet.h"
 #include "src/transform/Normalize.h"
 
+static ResultCache* cache = nullptr;
+
+// interned feature names, created at module initialization
+static PyObject* base_keys = nullptr;
+static PyObject* gate_keys = nullptr;
+static PyObject* wcnf_base_keys = nullptr;
+static PyObject* opb_base_keys = nullptr;
+
+static PyObject* emergency(const char* key, const char* reason) {
+    PyObject *dict = pydict();
+    pydict(dict, key, reason);
+    return dict;
+}
+
 static PyObject* version(PyObject* self) {
-    return pytype(1);
+    return pytype(GBDC_VERSION);
+}
+
+static PyObject* set_cache(PyObject* self, PyObject* arg) {
+    const char* directory;
+    if (!PyArg_ParseTuple(arg, "s", &directory)) return nullptr;
+    delete cache;
+    cache = new ResultCache(directory);
+    return PyBool_FromLong(cache->enabled());
 }
 
 static PyObject* gbdhash(PyObject* self, PyObject* arg) {
-    const char* filename;
-    PyArg_ParseTuple(arg, "s", &filename);
-    std::string result = CNF::gbdhash(filename);
+    PyInput input;
+    if (!PyArg_ParseTuple(arg, "O&", PyInput::convert, &input)) return nullptr;
+    const char* filename = input.filename();
+    std::string result = cache->fetch(filename, "cnf.gbdhash", [&] { return CNF::gbdhash(filename); });
     return pytype(result.c_str());
 }
 
+static PyObject* gbdhash_batch(PyObject* self, PyObject* arg) {
+    PyObject* files;
+    if (!PyArg_ParseTuple(arg, "O", &files)) return nullptr;
+    PyObject* seq = PySequence_Fast(files, "expected a sequence of filenames or contents of files");
+    if (seq == nullptr) return nullptr;
+    std::vector<std::unique_ptr<PyInput>> inputs;
+    std::vector<std::string> filenames;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+        inputs.emplace_back(new PyInput());
+        if (!PyInput::convert(PySequence_Fast_GET_ITEM(seq, i), inputs.back().get())) {
+            Py_DECREF(seq);
+            return nullptr;
+        }
+        filenames.push_back(inputs.back()->filename());
+    }
+    Py_DECREF(seq);
+
+    std::vector<std::string> hashes(filenames.size());
+    std::vector<std::string> missing;
+    for (unsigned i = 0; i < filenames.size(); ++i) {
+        if (!cache->get(filenames[i].c_str(), "cnf.gbdhash", &hashes[i])) missing.push_back(filenames[i]);
+    }
+    std::vector<std::string> computed = CNF::gbdhash_batch(missing);
+    PyObject* list = pylist();
+    for (unsigned i = 0, j = 0; i < filenames.size(); ++i) {
+        if (hashes[i].empty()) {
+            hashes[i] = computed[j++];
+            if (hashes[i].empty()) {  // parser error
+                PyList_Append(list, Py_None);
+                continue;
+            }
+            cache->put(filenames[i].c_str(), "cnf.gbdhash", hashes[i]);
+        }
+        pylist(list, hashes[i].c_str());
+    }
+    return list;
+}
+
 static PyObject* isohash(PyObject* self, PyObject* arg) {
-    const char* filename;
-    PyArg_ParseTuple(arg, "s", &filename);
-    std::string result = CNF::isohash(filename);
+    PyInput input;
+    if (!PyArg_ParseTuple(arg, "O&", PyInput::convert, &input)) return nullptr;
+    const char* filename = input.filename();
+    std::string result = cache->fetch(filename, "cnf.isohash", [&] { return CNF::isohash(filename); });
     return pytype(result.c_str());
 }
 
 static PyObject* opbhash(PyObject* self, PyObject* arg) {
-    const char* filename;
-    PyArg_ParseTuple(arg, "s", &filename);
-    std::string result = OPB::gbdhash(filename);
+    PyInput input;
+    if (!PyArg_ParseTuple(arg, "O&", PyInput::convert, &input)) return nullptr;
+    const char* filename = input.filename();
+    std::string result = cache->fetch(filename, "opb.gbdhash", [&] { return OPB::gbdhash(filename); });
     return pytype(result.c_str());
 }
 
 static PyObject* pqbfhash(PyObject* self, PyObject* arg) {
-    const char* filename;
-    PyArg_ParseTuple(arg, "s", &filename);
-    std::string result = PQBF::gbdhash(filename);
+    PyInput input;
+    if (!PyArg_ParseTuple(arg, "O&", PyInput::convert, &input)) return nullptr;
+    const char* filename = input.filename();
+    std::string result = cache->fetch(filename, "pqbf.gbdhash", [&] { return PQBF::gbdhash(filename); });
     return pytype(result.c_str());
 }
 
 static PyObject* wcnfhash(PyObject* self, PyObject* arg) {
-    const char* filename;
-    PyArg_ParseTuple(arg, "s", &filename);
-    std::string result = WCNF::gbdhash(filename);
+    PyInput input;
+    if (!PyArg_ParseTuple(arg, "O&", PyInput::convert, &input)) return nullptr;
+    const char* filename = input.filename();
+    std::string result = cache->fetch(filename, "wcnf.gbdhash", [&] { return WCNF::gbdhash(filename); });
     return pytype(result.c_str());
 }
 
 static PyObject* wcnfisohash(PyObject* self, PyObject* arg) {
-    const char* filename;
-    PyArg_ParseTuple(arg, "s", &filename);
-    std::string result = WCNF::isohash(filename);
+    PyInput input;
+    if (!PyArg_ParseTuple(arg, "O&", PyInput::convert, &input)) return nullptr;
+    const char* filename = input.filename();
+    std::string result = cache->fetch(filename, "wcnf.isohash", [&] { return WCNF::isohash(filename); });
     return pytype(result.c_str());
 }
 
 
 static PyObject* extract_base_features(PyObject* self, PyObject* arg) {
-    const char* filename;
-    unsigned rlim = 0, mlim = 0;
-    PyArg_ParseTuple(arg, "s|II", &filename, &rlim, &mlim);
+    PyInput input;
+    unsigned rlim = 0, mlim = 0, wlim = 0;
+    if (!PyArg_ParseTuple(arg, "O&|III", PyInput::convert, &input, &rlim, &mlim, &wlim)) return nullptr;
+    const char* filename = input.filename();
 
-    PyObject *emergency = pydict();
-    pydict(emergency, "base_features_runtime", "memout");
 
-    ResourceLimits limits(rlim, mlim);
-    limits.set_rlimits();
+    ResourceLimits limits(rlim, mlim, 0, wlim);
+    limits.set_rlimits(false);
     try {
         CNF::BaseFeatures stats(filename);
-        stats.extract();
-        std::vector<double> record = stats.getFeatures();
-        std::vector<std::string> names = stats.getNames();
+        std::vector<double> record = cache->fetch(filename, "cnf.base_features", [&] {
+            stats.extract();
+            return stats.getFeatures();
+        });
         PyObject *dict = pydict();
         pydict(dict, "base_features_runtime", limits.get_runtime());
-        for (unsigned int i = 0; i < record.size(); i++) {
-            pydict(dict, names[i].c_str(), record[i]);
+        pyrecord(dict, base_keys, record);
+        return dict;
+    } catch (TimeLimitExceeded& e) {
+        return emergency("base_features_runtime", "timeout");
+    } catch (MemoryLimitExceeded& e) {
+        return emergency("base_features_runtime", "memout");
+    }
+}
+
+
+static PyObject* ingest(PyObject* self, PyObject* arg) {
+    PyInput input;
+    unsigned rlim = 0, mlim = 0, wlim = 0;
+    if (!PyArg_ParseTuple(arg, "O&|III", PyInput::convert, &input, &rlim, &mlim, &wlim)) return nullptr;
+    const char* filename = input.filename();
+
+
+    ResourceLimits limits(rlim, mlim, 0, wlim);
+    limits.set_rlimits(false);
+    try {
+        std::string hash, isohash;
+        std::vector<double> record;
+        CNF::SinglePass stats(filename);
+        if (!cache->get(filename, "cnf.gbdhash", &hash) || !cache->get(filename, "cnf.isohash", &isohash)
+                || !cache->get(filename, "cnf.base_features", &record)) {
+            stats.extract();
+            hash = stats.getGBDHash();
+            isohash = stats.getIsoHash();
+            record = stats.getFeatures();
+            cache->put(filename, "cnf.gbdhash", hash);
+            cache->put(filename, "cnf.isohash", isohash);
+            cache->put(filename, "cnf.base_features", record);
         }
+        PyObject *dict = pydict();
+        pydict(dict, "gbdhash", hash.c_str());
+        pydict(dict, "isohash", isohash.c_str());
+        pydict(dict, "base_features_runtime", limits.get_runtime());
+        pyrecord(dict, base_keys, record);
         return dict;
     } catch (TimeLimitExceeded& e) {
-        pydict(emergency, "base_features_runtime", "timeout");
-        return emergency;
+        return emergency("base_features_runtime", "timeout");
     } catch (MemoryLimitExceeded& e) {
-        return emergency;
+        return emergency("base_features_runtime", "memout");
     }
 }
 
 
 static PyObject* extract_gate_features(PyObject* self, PyObject* arg) {
-    const char* filename;
-    unsigned rlim = 0, mlim = 0;
-    PyArg_ParseTuple(arg, "s|II", &filename, &rlim, &mlim);
+    PyInput input;
+    unsigned rlim = 0, mlim = 0, wlim = 0;
+    if (!PyArg_ParseTuple(arg, "O&|III", PyInput::convert, &input, &rlim, &mlim, &wlim)) return nullptr;
+    const char* filename = input.filename();
 
-    PyObject *emergency = pydict();
-    pydict(emergency, "gate_features_runtime", "memout");
 
-    ResourceLimits limits(rlim, mlim);
-    limits.set_rlimits();
+    ResourceLimits limits(rlim, mlim, 0, wlim);
+    limits.set_rlimits(false);
     try {
         CNFGateFeatures stats(filename);
         stats.extract();
         std::vector<double> record = stats.getFeatures();
-        std::vector<std::string> names = stats.getNames();
         PyObject *dict = pydict();
-        for (unsigned int i = 0; i < record.size(); i++) {
-            pydict(dict, names[i].c_str(), record[i]);
-        }
+        pyrecord(dict, gate_keys, record);
         pydict(dict, "gate_features_runtime", limits.get_runtime());
         return dict;
     } catch (TimeLimitExceeded& e) {
-        pydict(emergency, "gate_features_runtime", "timeout");
-        return emergency;
+        return emergency("gate_features_runtime", "timeout");
     } catch (MemoryLimitExceeded& e) {
-        return emergency;
+        return emergency("gate_features_runtime", "memout");
     }
 }
 
 
 static PyObject* extract_wcnf_base_features(PyObject* self, PyObject* arg) {
-    const char* filename;
-    unsigned rlim = 0, mlim = 0;
-    PyArg_ParseTuple(arg, "s|II", &filename, &rlim, &mlim);
+    PyInput input;
+    unsigned rlim = 0, mlim = 0, wlim = 0;
+    if (!PyArg_ParseTuple(arg, "O&|III", PyInput::convert, &input, &rlim, &mlim, &wlim)) return nullptr;
+    const char* filename = input.filename();
 
-    PyObject *emergency = pydict();
-    pydict(emergency, "base_features_runtime", "memout");
 
-    ResourceLimits limits(rlim, mlim);
-    limits.set_rlimits();
+    ResourceLimits limits(rlim, mlim, 0, wlim);
+    limits.set_rlimits(false);
     try {
         WCNF::BaseFeatures stats(filename);
-        stats.extract();
-        std::vector<double> record = stats.getFeatures();
-        std::vector<std::string> names = stats.getNames();
+        std::vector<double> record = cache->fetch(filename, "wcnf.base_features", [&] {
+            stats.extract();
+            return stats.getFeatures();
+        });
         PyObject *dict = pydict();
         pydict(dict, "base_features_runtime", limits.get_runtime());
-        for (unsigned int i = 0; i < record.size(); i++) {
-            pydict(dict, names[i].c_str(), record[i]);
-        }
+        pyrecord(dict, wcnf_base_keys, record);
         return dict;
     } catch (TimeLimitExceeded& e) {
-        pydict(emergency, "base_features_runtime", "timeout");
-        return emergency;
+        return emergency("base_features_runtime", "timeout");
     } catch (MemoryLimitExceeded& e) {
-        return emergency;
+        return emergency("base_features_runtime", "memout");
     }
 }
 
 
 static PyObject* extract_opb_base_features(PyObject* self, PyObject* arg) {
-    const char* filename;
-    unsigned rlim = 0, mlim = 0;
-    PyArg_ParseTuple(arg, "s|II", &filename, &rlim, &mlim);
+    PyInput input;
+    unsigned rlim = 0, mlim = 0, wlim = 0;
+    if (!PyArg_ParseTuple(arg, "O&|III", PyInput::convert, &input, &rlim, &mlim, &wlim)) return nullptr;
+    const char* filename = input.filename();
 
-    PyObject *emergency = pydict();
-    pydict(emergency, "base_features_runtime", "memout");
 
-    ResourceLimits limits(rlim, mlim);
-    limits.set_rlimits();
+    ResourceLimits limits(rlim, mlim, 0, wlim);
+    limits.set_rlimits(false);
     try {
         OPB::BaseFeatures stats(filename);
-        stats.extract();
-        std::vector<double> record = stats.getFeatures();
-        std::vector<std::string> names = stats.getNames();
+        std::vector<double> record = cache->fetch(filename, "opb.base_features", [&] {
+            stats.extract();
+            return stats.getFeatures();
+        });
         PyObject *dict = pydict();
         pydict(dict, "base_features_runtime", limits.get_runtime());
-        for (unsigned int i = 0; i < record.size(); i++) {
-            pydict(dict, names[i].c_str(), record[i]);
-        }
+        pyrecord(dict, opb_base_keys, record);
         return dict;
     } catch (TimeLimitExceeded& e) {
-        pydict(emergency, "base_features_runtime", "timeout");
-        return emergency;
+        return emergency("base_features_runtime", "timeout");
     } catch (MemoryLimitExceeded& e) {
-        return emergency;
+        return emergency("base_features_runtime", "memout");
     }
 }
 
 static PyObject* base_feature_names(PyObject* self) {
-    PyObject *list = PyList_New(0);
-    PyList_Append(list, pytype("base_features_runtime"));
-    CNF::BaseFeatures stats("");
-    std::vector<std::string> names = stats.getNames();
-    for (unsigned int i = 0; i < names.size(); i++) {
-        PyList_Append(list, pytype(names[i].c_str()));
-    }
-    return list;
+    return pylist("base_features_runtime", base_keys);
 }
 
 static PyObject* gate_feature_names(PyObject* self) {
-    PyObject *list = PyList_New(0);
-    PyList_Append(list, pytype("gate_features_runtime"));
-    CNFGateFeatures stats("");
-    std::vector<std::string> names = stats.getNames();
-    for (unsigned int i = 0; i < names.size(); i++) {
-        PyList_Append(list, pytype(names[i].c_str()));
-    }
-    return list;
+    return pylist("gate_features_runtime", gate_keys);
 }
 
 static PyObject* wcnf_base_feature_names(PyObject* self) {
-    PyObject *list = PyList_New(0);
-    PyList_Append(list, pytype("base_features_runtime"));
-    WCNF::BaseFeatures stats("");
-    std::vector<std::string> names = stats.getNames();
-    for (unsigned int i = 0; i < names.size(); i++) {
-        PyList_Append(list, pytype(names[i].c_str()));
-    }
-    return list;
+    return pylist("base_features_runtime", wcnf_base_keys);
 }
 
 static PyObject* opb_base_feature_names(PyObject* self) {
-    PyObject *list = PyList_New(0);
-    PyList_Append(list, pytype("base_features_runtime"));
-    OPB::BaseFeatures stats("");
-    std::vector<std::string> names = stats.getNames();
-    for (unsigned int i = 0; i < names.size(); i++) {
-        PyList_Append(list, pytype(names[i].c_str()));
-    }
-    return list;
+    return pylist("base_features_runtime", opb_base_keys);
 }
 
 
-static PyObject* cnf2kis(PyObject* self, PyObject* arg) {
-    const char* filename;
+static PyObject* cnf2kis(PyObject* self, PyObject* arg, PyObject* kwargs) {
+    static const char* kwlist[] = { "filename", "output", "maxEdges", "maxNodes", "rlim", "mlim", "flim", "compression", "level", "threads", "wlim", "format", "workers", nullptr };
+    PyInput input;
     const char* output;
     unsigned maxEdges, maxNodes;
-    unsigned rlim = 0, mlim = 0, flim = 0;
-    PyArg_ParseTuple(arg, "ssII|III", &filename, &output, &maxEdges, &maxNodes, &rlim, &mlim, &flim);
+    unsigned rlim = 0, mlim = 0, flim = 0, wlim = 0;
+    const char* filter = nullptr;
+    const char* format = nullptr;
+    unsigned workers = 1;
+    CompressionOptions compression;
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O&sII|IIIziIIzI", const_cast<char**>(kwlist), PyInput::convert, &input, &output, &maxEdges, &maxNodes,
+            &rlim, &mlim, &flim, &filter, &compression.level, &compression.threads, &wlim, &format, &workers)) {
+        return NULL;
+    }
+    GraphFormat graph;
+    try {
+        graph = graph_format(format != nullptr ? format : "", output);
+    } catch (std::invalid_argument& e) {
+        PyErr_SetString(PyExc_ValueError, e.what());
+        return NULL;
+    }
+    const char* filename = input.filename();
+    if (filter != nullptr) compression.filter = filter;
+    static const std::vector<std::string> filters = { "", "xz", "lzma", "zstd", "gzip", "bzip2", "none" };
+    if (std::find(filters.begin(), filters.end(), compression.filter) == filters.end()) {
+        PyErr_SetString(PyExc_ValueError, ("Unknown compression filter: " + compression.filter).c_str());
+        return NULL;
+    }
 
     PyObject *dict = pydict();
     pydict(dict, "nodes", 0);
     pydict(dict, "edges", 0);
     pydict(dict, "k", 0);
 
-    ResourceLimits limits(rlim, mlim, flim);
-    limits.set_rlimits();
+    ResourceLimits limits(rlim, mlim, flim, wlim);
+    limits.set_rlimits(false);
     try {
         IndependentSetFromCNF gen(filename);
-        unsigned nNodes = gen.numNodes();
-        unsigned nEdges = gen.numEdges();
-        unsigned minK = gen.minK();
+        uint64_t nNodes = gen.numNodes();
+        uint64_t nEdges = gen.numEdges();
+        uint64_t minK = gen.minK();
 
         pydict(dict, "nodes", nNodes);
         pydict(dict, "edges", nEdges);
@@ -275,11 +364,13 @@ static PyObject* cnf2kis(PyObject* self, PyObject* arg) {
             return dict;
         }
 
-        gen.generate_independent_set_problem(output);
+        gen.generate_independent_set_problem(output, compression, workers, graph);
         pydict(dict, "local", output);
 
-        std::string hash = CNF::gbdhash(output);
-        pydict(dict, "hash", hash.c_str());
+        if (graph == GraphFormat::KIS) {
+            std::string hash = CNF::gbdhash(output);
+            pydict(dict, "hash", hash.c_str());
+        }
 
         return dict;
     } catch (TimeLimitExceeded& e) {
@@ -298,14 +389,16 @@ static PyObject* cnf2kis(PyObject* self, PyObject* arg) {
 }
 
 static PyObject* print_sanitized(PyObject* self, PyObject* arg) {
-    const char* filename;
-    unsigned rlim = 0, mlim = 0;
-    PyArg_ParseTuple(arg, "s|II", &filename, &rlim, &mlim);
-
-    ResourceLimits limits(rlim, mlim);
-    limits.set_rlimits();
+    PyInput input;
+    unsigned rlim = 0, mlim = 0, wlim = 0;
+    const char* output = nullptr;
+    if (!PyArg_ParseTuple(arg, "O&|IIzI", PyInput::convert, &input, &rlim, &mlim, &output, &wlim)) return nullptr;
+    const char* filename = input.filename();
+
+    ResourceLimits limits(rlim, mlim, 0, wlim);
+    limits.set_rlimits(false);
     try {
-        sanitize(filename);
+        sanitize(filename, output);
         Py_RETURN_TRUE;
     } catch (TimeLimitExceeded& e) {
         Py_RETURN_FALSE;
@@ -314,14 +407,123 @@ static PyObject* print_sanitized(PyObject* self, PyObject* arg) {
     }
 }
 
+static PyObject* map_archive(PyObject* self, PyObject* arg, PyObject* kwargs) {
+    Py_ssize_t nargs = PyTuple_GET_SIZE(arg);
+    if (nargs < 2 || !PyCallable_Check(PyTuple_GET_ITEM(arg, 1))) {
+        PyErr_SetString(PyExc_TypeError, "expected archive (path or bytes-like object), function, and further arguments of function");
+        return nullptr;
+    }
+    PyInput input;
+    if (!PyInput::convert(PyTuple_GET_ITEM(arg, 0), &input)) return nullptr;
+    PyObject* function = PyTuple_GET_ITEM(arg, 1);
+
+    // keyword suffixes (str or tuple of str) selects the entries, further keywords are passed to the function
+    std::vector<std::string> suffixes;
+    PyObject* fkwargs = kwargs != nullptr ? PyDict_Copy(kwargs) : nullptr;
+    PyObject* selection = fkwargs != nullptr ? PyDict_GetItemString(fkwargs, "suffixes") : nullptr;
+    if (selection != nullptr) {
+        PyObject* seq = PyUnicode_Check(selection) ? PyTuple_Pack(1, selection) : PySequence_Tuple(selection);
+        for (Py_ssize_t i = 0; seq != nullptr && i < PyTuple_GET_SIZE(seq); ++i) {
+            const char* suffix = PyUnicode_AsUTF8(PyTuple_GET_ITEM(seq, i));
+            if (suffix == nullptr) break;
+            suffixes.push_back(suffix);
+        }
+        Py_XDECREF(seq);
+        PyDict_DelItemString(fkwargs, "suffixes");
+        if (PyErr_Occurred()) {
+            Py_DECREF(fkwargs);
+            return nullptr;
+        }
+    }
+
+    PyObject* dict = pydict();
+    if (dict == nullptr) {
+        Py_XDECREF(fkwargs);
+        return nullptr;
+    }
+    try {
+        ArchiveReader archive(input.filename());
+        while (archive.next()) {
+            const std::string& path = archive.path();
+            if (!suffixes.empty() && std::none_of(suffixes.begin(), suffixes.end(), [&path] (const std::string& suffix) {
+                    return path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+                })) {
+                continue;
+            }
+            // function(content, *args, **kwargs), the content is moved behind a read-only memoryview instead of copied,
+            // such that it stays valid if the function keeps it
+            PyObject* args = PyTuple_New(nargs - 1);
+            PyObject* content = pycontent(archive.take_data());
+            if (args == nullptr || content == nullptr) {
+                Py_XDECREF(args);
+                Py_XDECREF(content);
+                break;
+            }
+            PyTuple_SET_ITEM(args, 0, content);
+            for (Py_ssize_t i = 2; i < nargs; ++i) {
+                Py_INCREF(PyTuple_GET_ITEM(arg, i));
+                PyTuple_SET_ITEM(args, i - 1, PyTuple_GET_ITEM(arg, i));
+            }
+            PyObject* result = PyObject_Call(function, args, fkwargs);
+            Py_DECREF(args);
+            // entry paths are not interned, archives can hold arbitrarily many of them
+            PyObject* key = result != nullptr ? PyUnicode_DecodeFSDefault(path.c_str()) : nullptr;
+            int r = key != nullptr ? PyDict_SetItem(dict, key, result) : -1;
+            Py_XDECREF(result);
+            Py_XDECREF(key);
+            if (r != 0) break;
+        }
+    } catch (ParserException& e) {
+        PyErr_SetString(PyExc_ValueError, e.what());
+    }
+    Py_XDECREF(fkwargs);
+    if (PyErr_Occurred()) {
+        Py_DECREF(dict);
+        return nullptr;
+    }
+    return dict;
+}
+
+static PyObject* set_decompression_threads(PyObject* self, PyObject* arg) {
+    unsigned threads;
+    if (!PyArg_ParseTuple(arg, "I", &threads)) return nullptr;
+    decompression_threads() = threads;
+    Py_RETURN_NONE;
+}
+
+static PyObject* set_profiling(PyObject* self, PyObject* arg) {
+    int enabled = 1;
+    PyArg_ParseTuple(arg, "|p", &enabled);
+    Profiler::instance().enable(enabled);
+    Py_RETURN_NONE;
+}
+
+static PyObject* profile(PyObject* self, PyObject* arg) {
+    int reset = 1;
+    PyArg_ParseTuple(arg, "|p", &reset);
+    PyObject *dict = pydict();
+    for (const auto& entry : Profiler::instance().stages()) {
+        PyObject *stage = pydict();
+        pydict(stage, "calls", entry.second.calls);
+        pydict(stage, "wall_ns", entry.second.wall_ns);
+        pydict(stage, "cpu_ns", entry.second.cpu_ns);
+        pydict(stage, "bytes", entry.second.bytes);
+        pydict(dict, entry.first.c_str(), stage);
+    }
+    if (reset) Profiler::instance().reset();
+    return dict;
+}
+
 static PyMethodDef myMethods[] = {
     {"extract_gate_features", extract_gate_features, METH_VARARGS, "Extract Gate Features."},
     {"extract_base_features", extract_base_features, METH_VARARGS, "Extract Base Features."},
+    {"ingest", ingest, METH_VARARGS, "Calculate GBD-Hash, ISO-Hash and Base Features of given DIMACS CNF file in a single pass."},
     {"base_feature_names", (PyCFunction)base_feature_names, METH_NOARGS, "Get Base Feature Names."},
     {"gate_feature_names", (PyCFunction)gate_feature_names, METH_NOARGS, "Get Gate Feature Names."},
-    {"sanitize", print_sanitized, METH_VARARGS, "Print sanitized, i.e., no duplicate literals in clauses and no tautologic clauses, CNF to stdout."},
-    {"cnf2kis", cnf2kis, METH_VARARGS, "Create k-ISP Instance from given CNF Instance."},
-    {"gbdhash", gbdhash, METH_VARARGS, "Calculates GBD-Hash (md5 of normalized file) of given DIMACS CNF file."},
+    {"sanitize", print_sanitized, METH_VARARGS, "Print sanitized, i.e., no duplicate literals in clauses and no tautologic clauses, CNF to stdout or to given output file (compressed by extension)."},
+    {"cnf2kis", (PyCFunction)(void(*)(void))cnf2kis, METH_VARARGS | METH_KEYWORDS, "Create k-ISP Instance from given CNF Instance, optionally with compression filter, level and number of threads, graph format (kis, dimacs, metis, csr; hash only for kis), and number of workers which format edges (1: serial, default, 0: one per core)."},
+    {"gbdhash", gbdhash, METH_VARARGS, "Calculates GBD-Hash (md5 of normalized file) of given DIMACS CNF file, given by path or as bytes-like content (compressed or not)."},
+    {"gbdhash_batch", gbdhash_batch, METH_VARARGS, "Calculates GBD-Hashes of given list of DIMACS CNF files side by side in the lanes of a multi-buffer md5 (None for files which can not be parsed)."},
     {"isohash", isohash, METH_VARARGS, "Calculates ISO-Hash (md5 of sorted degree sequence) of given DIMACS CNF file."},
     {"opbhash", opbhash, METH_VARARGS, "Calculates OPB-Hash (md5 of normalized file) of given OPB file."},
     {"pqbfhash", pqbfhash, METH_VARARGS, "Calculates PQBF-Hash (md5 of normalized file) of given PQBF file."},
@@ -331,7 +533,12 @@ static PyMethodDef myMethods[] = {
     {"wcnf_base_feature_names", (PyCFunction)wcnf_base_feature_names, METH_NOARGS, "Get WCNF Base Feature Names."},
     {"extract_opb_base_features", extract_opb_base_features, METH_VARARGS, "Extract OPB Base Features."},
     {"opb_base_feature_names", (PyCFunction)opb_base_feature_names, METH_NOARGS, "Get OPB Base Feature Names."},
+    {"map_archive", (PyCFunction)(void(*)(void))map_archive, METH_VARARGS | METH_KEYWORDS, "Apply given function, e.g., gbdhash or extract_base_features, with given further arguments to the content of each file in given archive (tar, zip, etc.), decompressing the archive once, and return the results keyed by path in archive. The content is a read-only memoryview of the decompressed file. Keyword suffixes restricts the files to the given suffixes, e.g., ('.cnf', '.cnf.xz')."},
     {"version", (PyCFunction)version, METH_NOARGS, "Returns Version"},
+    {"set_cache", set_cache, METH_VARARGS, "Set result cache directory for hashes and base features (empty string disables the cache)."},
+    {"set_decompression_threads", set_decompression_threads, METH_VARARGS, "Set number of threads for decompressing multi-block xz and multi-frame zstd input (1: serial, default, 0: one per core)."},
+    {"set_profiling", set_profiling, METH_VARARGS, "Enable (default) or disable per-stage profiling."},
+    {"profile", profile, METH_VARARGS, "Get per-stage profile (calls, wall_ns, cpu_ns, bytes per stage) collected since the last reset, and reset it unless False is given."},
     {nullptr, nullptr, 0, nullptr}
 };
 
@@ -344,5 +551,11 @@ static struct PyModuleDef myModule = {
 };
 
 PyMODINIT_FUNC PyInit_gbdc(void) {
+    cache = new ResultCache();
+    base_keys = pykeys(CNF::BaseFeatures("").getNames());
+    gate_keys = pykeys(CNFGateFeatures("").getNames());
+    wcnf_base_keys = pykeys(WCNF::BaseFeatures("").getNames());
+    opb_base_keys = pykeys(OPB::BaseFeatures("").getNames());
+    if (base_keys == nullptr || gate_keys == nullptr || wcnf_base_keys == nullptr || opb_base_keys == nullptr) return nullptr;
     return PyModule_Create(&myModule);
 }
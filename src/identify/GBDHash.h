@@ -20,33 +20,155 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef GBDHASH_H_
 #define GBDHASH_H_
 
+#include <cstring>
+#include <memory>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "lib/md5/md5.h"
+#include "lib/md5/md5_mb.h"
 #include "src/util/StreamBuffer.h"
+#include "src/util/PrefetchReader.h"
 
 namespace CNF {
+    /**
+     * @brief Normalized clause stream of a DIMACS CNF file, as hashed by gbdhash
+     * Header and comments are dropped, each clause is emitted as its literals followed by 0,
+     * consecutive clauses are separated by a single space.
+     */
+    class GBDNormalizer {
+        StreamBuffer in;
+        bool notfirst;
+        std::string plit;
+
+     public:
+        explicit GBDNormalizer(const char* filename) : in(filename), notfirst(false), plit() { }
+
+        GBDNormalizer(const char* data, size_t size, const char* filename) : in(data, size, filename), notfirst(false), plit() { }
+
+        /**
+         * @brief emit next clause to out, which can be anything with consume(const char*, unsigned)
+         * @return false if eof was reached, true otherwise
+         */
+        template <typename Sink>
+        bool next(Sink& out) {
+            if (!in.skipWhitespace()) return false;
+            if (*in == 'p' || *in == 'c') {
+                return in.skipLine();
+            }
+            if (notfirst) out.consume(" ", 1);
+            while (in.readNumber(&plit)) {
+                if (plit == "0") break;
+                out.consume(plit.c_str(), plit.length());
+                out.consume(" ", 1);
+            }
+            out.consume("0", 1);
+            notfirst = true;
+            return true;
+        }
+    };
+
     std::string gbdhash(const char* filename) {
         MD5 md5;
-        StreamBuffer in(filename);
-        bool notfirst = false;
-        while (in.skipWhitespace()) {
-            if (*in == 'p' || *in == 'c') {
-                if (!in.skipLine()) break;
-            } else {
-                if (notfirst) md5.consume(" ", 1);
-                std::string plit;
-                while (in.readNumber(&plit)) {
-                    if (plit == "0") break;
-                    md5.consume(plit.c_str(), plit.length());
-                    md5.consume(" ", 1);
+        GBDNormalizer normalizer(filename);
+        while (normalizer.next(md5)) { }
+        return md5.produce();
+    }
+
+    /**
+     * @brief Calculate gbdhash of several files side by side in the lanes of the multi-buffer md5
+     * Each lane parses its file until a chunk of normalized text is buffered, then all lanes are hashed at once.
+     * Lanes of finished files are refilled with the next file, whose bytes are read ahead by a PrefetchReader.
+     * @return hashes in the order of the given files, empty string for files which could not be parsed
+     */
+    std::vector<std::string> gbdhash_batch(const std::vector<std::string>& filenames) {
+        const size_t chunk = 1 << 16;
+
+        // use the narrowest kernel which still gives each file its own lane
+        unsigned width = md5::mb_lanes();
+        while (width > 4 && width / 2 >= filenames.size()) width /= 2;
+        md5::mb_t mb(filenames.size() > 1 ? width : 1);
+
+        // stages single tokens and hands them to the lane in larger pieces
+        struct LaneSink {
+            md5::mb_t& mb;
+            unsigned lane;
+            char stage[4096];
+            unsigned staged;
+            LaneSink(md5::mb_t& mb_, unsigned lane_) : mb(mb_), lane(lane_), staged(0) { }
+            void consume(const char* str, unsigned length) {
+                if (staged + length > sizeof(stage)) flush();
+                if (length > sizeof(stage)) {
+                    mb.process(lane, str, length);
+                } else {
+                    std::memcpy(stage + staged, str, length);
+                    staged += length;
+                }
+            }
+            size_t pending() const {
+                return mb.pending(lane) + staged;
+            }
+            void flush() {
+                if (staged > 0) mb.process(lane, stage, staged);
+                staged = 0;
+            }
+        };
+
+        std::vector<std::string> hashes(filenames.size());
+        PrefetchReader prefetch(filenames);
+        std::vector<PrefetchReader::File> files(mb.lanes());
+        std::vector<std::unique_ptr<GBDNormalizer>> normalizers(mb.lanes());
+        std::vector<size_t> index(mb.lanes());
+        std::vector<bool> failed(mb.lanes());
+        size_t next = 0;
+        for (;;) {
+            bool busy = false;
+            for (unsigned lane = 0; lane < mb.lanes(); ++lane) {
+                if (!mb.busy(lane) && next < filenames.size()) {
+                    normalizers[lane].reset();
+                    prefetch.next(files[lane]);
+                    index[lane] = next++;
+                    failed[lane] = false;
+                    mb.start(lane);
+                    try {
+                        const PrefetchReader::File& file = files[lane];
+                        const char* filename = filenames[index[lane]].c_str();
+                        normalizers[lane].reset(file.loaded ? new GBDNormalizer(file.data.data(), file.data.size(), filename) : new GBDNormalizer(filename));
+                    } catch (ParserException& e) {
+                        failed[lane] = true;
+                        mb.finish(lane);
+                    }
+                }
+                if (normalizers[lane]) {
+                    LaneSink sink(mb, lane);
+                    try {
+                        while (sink.pending() < chunk && normalizers[lane]->next(sink)) { }
+                    } catch (ParserException& e) {
+                        failed[lane] = true;
+                    }
+                    sink.flush();
+                    if (failed[lane] || mb.pending(lane) < chunk) {
+                        mb.finish(lane);
+                        normalizers[lane].reset();
+                    }
+                }
+                busy |= mb.busy(lane);
+            }
+            if (!busy) break;
+            mb.run();
+            for (unsigned lane = 0; lane < mb.lanes(); ++lane) {
+                if (mb.done(lane)) {
+                    unsigned char sig[MD5_SIZE];
+                    char str[MD5_STRING_SIZE];
+                    mb.get_sig(lane, sig);
+                    if (failed[lane]) continue;
+                    md5::sig_to_string(sig, str, sizeof(str));
+                    hashes[index[lane]] = str;
                 }
-                md5.consume("0", 1);
-                notfirst = true;
             }
         }
-        return md5.produce();
+        return hashes;
     }
 } // namespace CNF 
 
@@ -21,57 +21,255 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define ISOHASH_H_
 
 #include <vector>
+#include <array>
 #include <algorithm>
+#include <exception>
+#include <limits>
+#include <thread>
 #include <stdio.h>
 
 #include "lib/md5/md5.h"
 
+#include "src/util/Cancellation.h"
+#include "src/util/MemoryBudget.h"
 #include "src/util/StreamBuffer.h"
 #include "src/util/SolverTypes.h"
+#include "src/util/NumberFormat.h"
+#include "src/util/Profiler.h"
+#include "src/util/WorkQueue.h"
 
+/**
+ * @brief Normalize and sort degree pairs lexicographically by (neg, pos)
+ * - degrees are flipped such that neg <= pos (invariant w.r.t. polarity flips)
+ * - nodes of degree zero are removed (invariant against variable gaps)
+ * - LSD radix sort with 8-bit digits, passes in which all keys share the same digit are skipped,
+ *   such that the typically small degrees need only one or two passes per component
+ * @param nodes the degree sequence, sorted in place
+ */
+template <typename Node>
+void sort_degree_sequence(std::vector<Node>& nodes) {
+    typedef decltype(Node::neg) T;
+    const unsigned digits = sizeof(T);  // 8-bit digits per component
+    const unsigned passes = 2 * digits;  // pos digits first, neg digits last
+    auto digit = [digits] (const Node& node, unsigned pass) -> unsigned {
+        return pass < digits ? (node.pos >> (8 * pass)) & 0xFF : (node.neg >> (8 * (pass - digits))) & 0xFF;
+    };
+
+    size_t n = 0;
+    for (Node node : nodes) {
+        if (node.neg == 0 && node.pos == 0) continue;
+        if (node.pos < node.neg) std::swap(node.pos, node.neg);
+        nodes[n++] = node;
+    }
+    nodes.resize(n);
+
+    if (n < 256) {
+        std::sort(nodes.begin(), nodes.end(), [](const Node& one, const Node& two) {
+            return one.neg != two.neg ? one.neg < two.neg : one.pos < two.pos;
+        });
+        return;
+    }
+
+    std::vector<std::array<size_t, 256>> count(passes);
+    for (std::array<size_t, 256>& histogram : count) histogram.fill(0);
+    for (const Node& node : nodes) {
+        for (unsigned pass = 0; pass < passes; ++pass) {
+            ++count[pass][digit(node, pass)];
+        }
+    }
+
+    std::vector<Node> buffer(n);
+    for (unsigned pass = 0; pass < passes; ++pass) {
+        std::array<size_t, 256>& offset = count[pass];
+        if (offset[digit(nodes[0], pass)] == n) continue;  // all keys share this digit
+        size_t sum = 0;
+        for (size_t& c : offset) {
+            size_t tmp = c;
+            c = sum;
+            sum += tmp;
+        }
+        for (const Node& node : nodes) {
+            buffer[offset[digit(node, pass)]++] = node;
+        }
+        nodes.swap(buffer);
+    }
+}
+
+/**
+ * @brief Feed sorted degree sequence to md5 as space separated text "neg pos neg pos ... "
+ */
+template <typename Node>
+void consume_degree_sequence(MD5& md5, const std::vector<Node>& nodes) {
+    char buffer[1 << 16];
+    unsigned pos = 0;
+    for (const Node& node : nodes) {
+        if (pos > sizeof(buffer) - 64) {
+            md5.consume(buffer, pos);
+            pos = 0;
+        }
+        pos += format_uint(buffer + pos, node.neg);
+        buffer[pos++] = ' ';
+        pos += format_uint(buffer + pos, node.pos);
+        buffer[pos++] = ' ';
+    }
+    md5.consume(buffer, pos);
+}
 
 namespace CNF {
+    struct IsoNode { unsigned neg; unsigned pos; };
+
+    /**
+     * @brief Hashsum of ordered degree sequence
+     * @param degrees literal node degrees per variable, reordered in place
+     * @return std::string isohash
+     */
+    std::string hash_degree_sequence(std::vector<IsoNode>& degrees) {
+        ScopedTimer timer("hash");
+        sort_degree_sequence(degrees);
+        MD5 md5;
+        consume_degree_sequence(md5, degrees);
+        return md5.produce();
+    }
+
+    /**
+     * @brief Count literal occurrences in a block of complete DIMACS lines
+     * @param degrees literal node degrees per variable, grown on demand
+     * @param memory charged with the heap memory of degrees before it grows
+     */
+    void count_literals(const std::vector<char>& block, std::vector<IsoNode>& degrees, MemoryAccount& memory, const char* filename) {
+        ScopedTimer timer("tokenize");
+        timer.add_bytes(block.size());
+        cancellation_point(block.size());
+        const char* pos = block.data();
+        const char* end = pos + block.size();
+        while (pos < end) {
+            const char c = *pos;
+            if (isspace(c)) {
+                ++pos;
+            } else if (c == 'c' || c == 'p') {
+                const char* eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+                pos = eol == nullptr ? end : eol;
+            } else {
+                bool negative = c == '-';
+                if (c == '-' || c == '+') ++pos;
+                if (pos == end || !isdigit(*pos)) {
+                    throw ParserException(std::string(filename) + ": unexpected character: " + c);
+                }
+                uint64_t var = 0;
+                while (pos < end && isdigit(*pos)) {
+                    var = 10 * var + (*pos - '0');
+                    if (var > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+                        throw ParserException(std::string(filename) + ": number out of int32 range");
+                    }
+                    ++pos;
+                }
+                if (var == 0) continue;
+                if (var > degrees.size()) {
+                    size_t size = std::max<size_t>(var, 2 * degrees.size());
+                    memory.set(size * sizeof(IsoNode));
+                    degrees.resize(size);
+                    memory.set(heap_bytes(degrees));
+                }
+                if (negative) ++degrees[var - 1].neg;
+                else ++degrees[var - 1].pos;
+            }
+        }
+    }
+
     /**
      * @brief Hashsum of ordered degree sequence of literal incidence graph
      * - literal nodes are grouped pairwise and sorted lexicographically
      * - edge weight of 1/n ==> literal node degree = occurence count
+     * - with several threads, degrees are counted on blocks of lines with thread-local arrays, which are summed up at the end
      * @param filename benchmark instance
+     * @param n_threads number of threads counting degrees, 1: serial (default), 0: one per core
      * @return std::string isohash
      */
-    std::string isohash(const char* filename) {
+    std::string isohash(const char* filename, unsigned n_threads = 1) {
         StreamBuffer in(filename);
-        struct Node { unsigned neg; unsigned pos; };
-        std::vector<Node> degrees;
-        while (in.skipWhitespace()) {
-            if (*in == 'p' || *in == 'c') {
-                if (!in.skipLine()) break;
-            } else {
-                int plit;
-                while (in.readInteger(&plit)) {
-                    if (abs(plit) >= degrees.size()) degrees.resize(abs(plit));
-                    if (plit == 0) break;
-                    else if (plit < 0) ++degrees[abs(plit) - 1].neg;
-                    else ++degrees[abs(plit) - 1].pos;
-                }
+        std::vector<IsoNode> degrees;
+        MemoryAccount memory;
+        // pre-size degree array from header
+        while (in.skipWhitespace() && *in == 'c') {
+            if (!in.skipLine()) break;
+        }
+        if (!in.eof() && *in == 'p') {
+            in.skip();
+            in.skipWhitespace();
+            while (!in.eof() && !isspace(*in)) in.skip();
+            int vars = 0;
+            if (in.skipWhitespace() && isdigit(*in) && in.readInteger(&vars)) {
+                memory.set(std::min(vars, 1 << 22) * sizeof(IsoNode));
+                degrees.resize(std::min(vars, 1 << 22));
             }
+            if (!in.eof()) in.skipLine();
         }
-        // get invariant w.r.t. polarity flips
-        for (Node& degree : degrees) {
-            if (degree.pos < degree.neg) std::swap(degree.pos, degree.neg);
+
+        const size_t block_size = 1 << 20;
+        std::vector<char> block;
+        if (!in.readLines(block, block_size)) {
+            return hash_degree_sequence(degrees);
         }
-        // sort lexicographically by degree
-        std::sort(degrees.begin(), degrees.end(), [](const Node& one, const Node& two) { 
-            return one.neg != two.neg ? one.neg < two.neg : one.pos < two.pos; 
-        } );
-        // hash
-        MD5 md5;
-        char buffer[64];
-        for (Node node : degrees) {
-            if (node.neg == 0 && node.pos == 0) continue;  // get invariant against variable gaps
-            int n = snprintf(buffer, sizeof(buffer), "%u %u ", node.neg, node.pos);
-            md5.consume(buffer, n);
+        if (n_threads == 0) n_threads = num_workers();
+        if (in.eof() || n_threads == 1) {
+            do {
+                count_literals(block, degrees, memory, filename);
+            } while (in.readLines(block, block_size));
+            return hash_degree_sequence(degrees);
         }
-        return md5.produce();
+
+        // thread-local arrays are charged to the budget of the caller
+        WorkQueue<std::vector<char>> queue(2 * n_threads);
+        std::vector<std::vector<IsoNode>> local(n_threads);
+        std::vector<MemoryAccount> local_memory(n_threads);
+        std::vector<std::exception_ptr> errors(n_threads);
+        CancellationToken* token = current_cancellation_token();
+        MemoryBudget* budget = current_memory_budget();
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < n_threads; ++i) {
+            workers.emplace_back([&, i] {
+                CancellationScope scope(token);
+                MemoryBudgetScope budget_scope(budget);
+                std::vector<char> work;
+                try {
+                    local_memory[i].set(degrees.size() * sizeof(IsoNode));
+                    local[i].resize(degrees.size());
+                    while (queue.pop(work)) {
+                        count_literals(work, local[i], local_memory[i], filename);
+                    }
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                    queue.close();
+                }
+            });
+        }
+        try {
+            do {
+                if (!queue.push(std::move(block))) break;
+            } while (in.readLines(block, block_size));
+        } catch (...) {
+            queue.close();
+            for (std::thread& worker : workers) worker.join();
+            throw;
+        }
+        queue.close();
+        for (std::thread& worker : workers) worker.join();
+        for (std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+
+        // reduce thread-local degree arrays
+        size_t size = 0;
+        for (const std::vector<IsoNode>& counts : local) size = std::max(size, counts.size());
+        memory.set(size * sizeof(IsoNode));
+        degrees.assign(size, IsoNode { 0, 0 });
+        for (const std::vector<IsoNode>& counts : local) {
+            for (size_t v = 0; v < counts.size(); ++v) {
+                degrees[v].neg += counts[v].neg;
+                degrees[v].pos += counts[v].pos;
+            }
+        }
+        return hash_degree_sequence(degrees);
     }
 } // namespace CNF
 
@@ -90,8 +288,11 @@ namespace WCNF {
                 in.skip();
                 in.skipWhitespace();
                 in.skipString("wcnf");
-                // skip vars
-                in.skipNumber();
+                // pre-size degree arrays
+                int vars = 0;
+                in.readInteger(&vars);
+                hard_degrees.resize(std::min(std::max(vars, 0), 1 << 22));
+                soft_degrees.resize(hard_degrees.size());
                 // skip clauses
                 in.skipNumber();
                 // extract top
@@ -102,7 +303,7 @@ namespace WCNF {
                 in.skip();
                 int plit;
                 while (in.readInteger(&plit)) {
-                    if (abs(plit) >= hard_degrees.size()) hard_degrees.resize(abs(plit));
+                    if (abs(plit) > hard_degrees.size()) hard_degrees.resize(abs(plit));
                     if (plit == 0) break;
                     else if (plit < 0) ++hard_degrees[abs(plit) - 1].neg;
                     else ++hard_degrees[abs(plit) - 1].pos;
@@ -114,7 +315,7 @@ namespace WCNF {
                     // old format hard clause
                     int plit;
                     while (in.readInteger(&plit)) {
-                        if (abs(plit) >= hard_degrees.size()) hard_degrees.resize(abs(plit));
+                        if (abs(plit) > hard_degrees.size()) hard_degrees.resize(abs(plit));
                         if (plit == 0) break;
                         else if (plit < 0) ++hard_degrees[abs(plit) - 1].neg;
                         else ++hard_degrees[abs(plit) - 1].pos;
@@ -123,7 +324,7 @@ namespace WCNF {
                     // soft clause
                     int plit;
                     while (in.readInteger(&plit)) {
-                        if (abs(plit) >= soft_degrees.size()) soft_degrees.resize(abs(plit));
+                        if (abs(plit) > soft_degrees.size()) soft_degrees.resize(abs(plit));
                         if (plit == 0) break;
                         else if (plit < 0) ++soft_degrees[abs(plit) - 1].neg += weight;
                         else ++soft_degrees[abs(plit) - 1].pos += weight;
@@ -134,31 +335,14 @@ namespace WCNF {
         // add hard degrees to soft degrees
         if (soft_degrees.size() < hard_degrees.size()) soft_degrees.resize(hard_degrees.size());
         std::transform(hard_degrees.begin(), hard_degrees.end(), soft_degrees.begin(), soft_degrees.begin(), [](Node a, Node b) { return Node { .neg = a.neg + b.neg, .pos = a.pos + b.pos }; });
-        // get invariant w.r.t. polarity flips
-        for (Node& degree : hard_degrees) {
-            if (degree.pos < degree.neg) std::swap(degree.pos, degree.neg);
-        }
-        for (Node& degree : soft_degrees) {
-            if (degree.pos < degree.neg) std::swap(degree.pos, degree.neg);
-        }
         // sort lexicographically by degree
-        auto lex_smaller = [](const Node& one, const Node& two) { return one.neg != two.neg ? one.neg < two.neg : one.pos < two.pos; };
-        std::sort(hard_degrees.begin(), hard_degrees.end(), lex_smaller);
-        std::sort(soft_degrees.begin(), soft_degrees.end(), lex_smaller);
+        sort_degree_sequence(hard_degrees);
+        sort_degree_sequence(soft_degrees);
         // hash
         MD5 md5;
-        char buffer[64];
-        for (Node node : hard_degrees) {
-            if (node.neg == 0 && node.pos == 0) continue;  // get invariant against variable gaps
-            int n = snprintf(buffer, sizeof(buffer), "%llu %llu ", node.neg, node.pos);
-            md5.consume(buffer, n);
-        }
+        consume_degree_sequence(md5, hard_degrees);
         md5.consume("softs ", 6);
-        for (Node node : soft_degrees) {
-            if (node.neg == 0 && node.pos == 0) continue;  // get invariant against variable gaps
-            int n = snprintf(buffer, sizeof(buffer), "%llu %llu ", node.neg, node.pos);
-            md5.consume(buffer, n);
-        }
+        consume_degree_sequence(md5, soft_degrees);
         return md5.produce();
     }
 } // namespace CNF
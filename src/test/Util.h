@@ -1,4 +1,6 @@
 #include <iostream>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
@@ -6,6 +8,30 @@
 #include <random>
 #include "src/util/SolverTypes.h"
 
+std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+// file name in the temporary directory, the file is removed at the end of the scope
+class TempPath : public std::filesystem::path
+{
+public:
+    explicit TempPath(const std::string& name) : std::filesystem::path(std::filesystem::temp_directory_path() / name) {}
+
+    ~TempPath()
+    {
+        std::error_code ec;
+        std::filesystem::remove(*this, ec);
+    }
+
+    TempPath(const TempPath&) = delete;
+    TempPath& operator=(const TempPath&) = delete;
+};
+
 std::unordered_map<std::string, double> record_to_map(std::string record_file_name)
 {
     std::ifstream record_file(record_file_name);
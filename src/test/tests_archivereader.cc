@@ -0,0 +1,120 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/util/ArchiveReader.h"
+#include "src/util/StreamBuffer.h"
+
+// archive of given format and filter with the given files (path, content) and directories (path, empty content: "/")
+std::vector<char> make_archive(int (*format)(struct archive*), int (*filter)(struct archive*), const std::vector<std::pair<std::string, std::string>>& files) {
+    std::vector<char> out(1 << 20);
+    size_t used = 0;
+    struct archive* a = archive_write_new();
+    format(a);
+    filter(a);
+    archive_write_open_memory(a, out.data(), out.size(), &used);
+    for (const auto& file : files) {
+        struct archive_entry* entry = archive_entry_new();
+        archive_entry_set_pathname(entry, file.first.c_str());
+        if (file.second == "/") {
+            archive_entry_set_filetype(entry, AE_IFDIR);
+            archive_entry_set_perm(entry, 0755);
+            archive_write_header(a, entry);
+        } else {
+            archive_entry_set_filetype(entry, AE_IFREG);
+            archive_entry_set_perm(entry, 0644);
+            archive_entry_set_size(entry, file.second.size());
+            archive_write_header(a, entry);
+            archive_write_data(a, file.second.data(), file.second.size());
+        }
+        archive_entry_free(entry);
+    }
+    archive_write_close(a);
+    archive_write_free(a);
+    out.resize(used);
+    return out;
+}
+
+std::vector<Cl> read_clauses(const char* filename) {
+    std::vector<Cl> clauses;
+    StreamBuffer in(filename);
+    Cl clause;
+    while (in.readClause(clause)) clauses.push_back(clause);
+    return clauses;
+}
+
+TEST_CASE("ArchiveReader") {
+    const char* cnf_xz = "src/test/resources/test.cnf.xz";
+    std::vector<char> compressed(std::filesystem::file_size(cnf_xz));
+    std::FILE* file = fopen(cnf_xz, "rb");
+    CHECK(fread(compressed.data(), 1, compressed.size(), file) == compressed.size());
+    fclose(file);
+
+    const std::string plain = "p cnf 3 2\n1 -2 0\n2 3 0\n";
+    const std::vector<std::pair<std::string, std::string>> files = {
+        { "set/", "/" },
+        { "set/plain.cnf", plain },
+        { "set/compressed.cnf.xz", std::string(compressed.data(), compressed.size()) },
+        { "set/empty.cnf", "" },
+    };
+
+    SUBCASE("tar.xz entries in order, compressed entries are decompressed") {
+        std::vector<char> tar = make_archive(archive_write_set_format_pax_restricted, archive_write_add_filter_xz, files);
+        MemoryFile memory(tar.data(), tar.size());
+        ArchiveReader archive(memory.name());
+        CHECK(archive.next());
+        CHECK(archive.path() == "set/plain.cnf");
+        CHECK(std::string(archive.data(), archive.size()) == plain);
+        CHECK(read_clauses(archive.filename()).size() == 2);
+        CHECK(archive.next());
+        CHECK(archive.path() == "set/compressed.cnf.xz");
+        CHECK(read_clauses(archive.filename()) == read_clauses(cnf_xz));
+        CHECK(archive.next());
+        CHECK(archive.path() == "set/empty.cnf");
+        CHECK(archive.size() == 0);
+        CHECK(!archive.next());
+    }
+
+    SUBCASE("zip") {
+        std::vector<char> zip = make_archive(archive_write_set_format_zip, archive_write_add_filter_none, files);
+        MemoryFile memory(zip.data(), zip.size());
+        ArchiveReader archive(memory.name());
+        std::vector<std::string> paths;
+        while (archive.next()) paths.push_back(archive.path());
+        CHECK(paths == std::vector<std::string>({ "set/plain.cnf", "set/compressed.cnf.xz", "set/empty.cnf" }));
+    }
+
+    SUBCASE("take data") {
+        // the content moves out of the reader, the following entries are read as before
+        std::vector<char> tar = make_archive(archive_write_set_format_pax_restricted, archive_write_add_filter_none, files);
+        MemoryFile memory(tar.data(), tar.size());
+        ArchiveReader archive(memory.name());
+        CHECK(archive.next());
+        std::vector<char> data = archive.take_data();
+        CHECK(std::string(data.data(), data.size()) == plain);
+        CHECK(archive.next());
+        CHECK(read_clauses(archive.filename()) == read_clauses(cnf_xz));
+        CHECK(archive.next());
+        CHECK(archive.data() != nullptr);
+        CHECK(archive.size() == 0);
+        CHECK(std::string(data.data(), data.size()) == plain);
+    }
+
+    SUBCASE("archive extensions") {
+        CHECK(ArchiveReader::is_archive("sat2024.tar.xz"));
+        CHECK(ArchiveReader::is_archive("sat2024.zip"));
+        CHECK(!ArchiveReader::is_archive("instance.cnf.xz"));
+        CHECK(!ArchiveReader::is_archive(".tar"));
+    }
+}
@@ -0,0 +1,138 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/util/BlockDecompressor.h"
+#include "src/util/StreamBuffer.h"
+
+// random formula with given number of clauses
+std::string formula(unsigned clauses) {
+    std::string text = "p cnf 1000 " + std::to_string(clauses) + "\n";
+    unsigned seed = 1;
+    for (unsigned i = 0; i < clauses; ++i) {
+        for (unsigned j = 0; j < 3; ++j) {
+            seed = seed * 1103515245 + 12345;
+            int lit = 1 + (seed >> 16) % 1000;
+            text += std::to_string((seed & 1) ? lit : -lit) + " ";
+        }
+        text += "0\n";
+    }
+    return text;
+}
+
+std::vector<Cl> read_clauses(const std::string& data, unsigned threads) {
+    decompression_threads() = threads;
+    std::vector<Cl> clauses;
+    StreamBuffer in(data.data(), data.size());
+    Cl clause;
+    while (in.readClause(clause)) clauses.push_back(clause);
+    decompression_threads() = 1;
+    return clauses;
+}
+
+#ifdef GBDC_HAVE_LZMA
+std::string xz(const std::string& text, uint64_t block_size) {
+    lzma_mt mt;
+    std::memset(&mt, 0, sizeof(mt));
+    mt.threads = 1;
+    mt.block_size = block_size;
+    mt.preset = 1;
+    mt.check = LZMA_CHECK_CRC64;
+    std::string out(lzma_stream_buffer_bound(text.size()), '\0');
+    lzma_stream strm = LZMA_STREAM_INIT;
+    REQUIRE(lzma_stream_encoder_mt(&strm, &mt) == LZMA_OK);
+    strm.next_in = reinterpret_cast<const uint8_t*>(text.data());
+    strm.avail_in = text.size();
+    strm.next_out = reinterpret_cast<uint8_t*>(&out[0]);
+    strm.avail_out = out.size();
+    REQUIRE(lzma_code(&strm, LZMA_FINISH) == LZMA_STREAM_END);
+    out.resize(strm.total_out);
+    lzma_end(&strm);
+    return out;
+}
+
+TEST_CASE("BlockDecompressor xz") {
+    std::string text = formula(20000);
+    std::vector<Cl> expected = read_clauses(text, 1);
+    REQUIRE(expected.size() == 20000);
+
+    SUBCASE("multi-block") {
+        std::string data = xz(text, 1 << 15);
+        // serial by default
+        CHECK(BlockDecompressor::open("", data.data(), data.size()) == nullptr);
+        decompression_threads() = 4;
+        auto blocks = BlockDecompressor::open("", data.data(), data.size());
+        decompression_threads() = 1;
+        REQUIRE(blocks != nullptr);
+        CHECK(blocks->blocks() > 2);
+        CHECK(read_clauses(data, 4) == expected);
+        CHECK(read_clauses(data, 1) == expected);
+    }
+
+    SUBCASE("single block falls back to serial decompression") {
+        std::string data = xz(text, 0);
+        decompression_threads() = 4;
+        CHECK(BlockDecompressor::open("", data.data(), data.size()) == nullptr);
+        decompression_threads() = 1;
+        CHECK(read_clauses(data, 4) == expected);
+    }
+
+    SUBCASE("corrupt block") {
+        std::string data = xz(text, 1 << 15);
+        data[data.size() / 2] ^= 0x55;
+        CHECK_THROWS_AS(read_clauses(data, 4), ParserException);
+        decompression_threads() = 1;
+    }
+
+    SUBCASE("corrupt stream read serially") {
+        std::string data = xz(text, 0);
+        data[data.size() / 2] ^= 0x55;
+        CHECK_THROWS_AS(read_clauses(data, 1), ParserException);
+        decompression_threads() = 1;
+    }
+}
+#endif
+
+#ifdef GBDC_HAVE_ZSTD
+TEST_CASE("BlockDecompressor zstd") {
+    std::string text = formula(20000);
+    std::vector<Cl> expected = read_clauses(text, 1);
+
+    // frames of about 64 KB, the last one without content size, and a skippable frame in between
+    std::string data;
+    size_t frame = 1 << 16;
+    for (size_t pos = 0; pos < text.size(); pos += frame) {
+        size_t length = std::min(frame, text.size() - pos);
+        std::string out(ZSTD_compressBound(length), '\0');
+        if (pos + frame < text.size()) {
+            out.resize(ZSTD_compress(&out[0], out.size(), text.data() + pos, length, 1));
+        } else {
+            ZSTD_CCtx* ctx = ZSTD_createCCtx();
+            ZSTD_inBuffer in = { text.data() + pos, length, 0 };
+            ZSTD_outBuffer o = { &out[0], out.size(), 0 };
+            CHECK(ZSTD_compressStream2(ctx, &o, &in, ZSTD_e_end) == 0);
+            out.resize(o.pos);
+            ZSTD_freeCCtx(ctx);
+        }
+        data += out;
+        if (pos == 0) data += std::string("\x50\x2A\x4D\x18\x04\x00\x00\x00skip", 12);
+    }
+
+    decompression_threads() = 4;
+    auto blocks = BlockDecompressor::open("", data.data(), data.size());
+    decompression_threads() = 1;
+    REQUIRE(blocks != nullptr);
+    CHECK(blocks->blocks() == (text.size() + frame - 1) / frame);
+    CHECK(read_clauses(data, 4) == expected);
+    CHECK(read_clauses(data, 1) == expected);
+}
+#endif
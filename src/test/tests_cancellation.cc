@@ -0,0 +1,98 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/util/Cancellation.h"
+#include "src/util/CNFFormula.h"
+#include "src/util/StreamBuffer.h"
+
+TEST_CASE("Cancellation") {
+    SUBCASE("token") {
+        CancellationToken none;
+        CHECK_FALSE(none.expired());
+        none.cancel();
+        CHECK(none.expired());
+        CHECK_THROWS_AS(none.check(), TimeLimitExceeded);
+
+        CancellationToken wall(5);
+        CHECK_FALSE(wall.expired());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(wall.expired());
+
+        CancellationToken cpu(0, 5);
+        auto start = std::chrono::steady_clock::now();
+        volatile uint64_t spin = 0;
+        while (!cpu.expired() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) ++spin;
+        CHECK(cpu.expired());
+    }
+
+    SUBCASE("worker cpu time") {
+        auto spin = [] (CancellationToken* token, unsigned ms) {
+            auto start = std::chrono::steady_clock::now();
+            volatile uint64_t count = 0;
+            while (!token->expired() && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(ms)) ++count;
+        };
+
+        // cpu time of the process includes worker threads
+        CancellationToken process(0, 5);
+        std::thread worker(spin, &process, 10000);
+        worker.join();
+        CHECK(process.expired());
+
+        // only threads with a scope of the token count, the creating thread does not without a scope
+        CancellationToken scopes(0, 5, CpuTime::SCOPES);
+        spin(&scopes, 20);
+        CHECK_FALSE(scopes.expired());
+        std::thread scoped([&] {
+            CancellationScope scope(&scopes);
+            spin(&scopes, 10000);
+        });
+        scoped.join();
+        CHECK(scopes.expired());
+    }
+
+    SUBCASE("scope") {
+        CHECK(current_cancellation_token() == nullptr);
+        CancellationToken outer, inner;
+        {
+            CancellationScope scope(&outer);
+            CHECK(current_cancellation_token() == &outer);
+            {
+                CancellationScope scope(&inner);
+                CHECK(current_cancellation_token() == &inner);
+                inner.cancel();
+                CHECK_THROWS_AS(check_cancellation(), TimeLimitExceeded);
+            }
+            CHECK(current_cancellation_token() == &outer);
+            CHECK_NOTHROW(check_cancellation());
+        }
+        CHECK(current_cancellation_token() == nullptr);
+        std::thread other([] { CHECK(current_cancellation_token() == nullptr); });
+        other.join();
+    }
+
+    SUBCASE("parser") {
+        std::filesystem::path input = std::filesystem::temp_directory_path() / "gbdc.test.cancellation.cnf";
+        {
+            std::ofstream out(input);
+            out << "p cnf 3 2\n1 2 0\n-1 3 0\n";
+        }
+        CancellationToken token;
+        CancellationScope scope(&token);
+        CHECK_NOTHROW(CNFFormula(input.c_str()));
+        token.cancel();
+        CHECK_THROWS_AS(CNFFormula(input.c_str()), TimeLimitExceeded);
+        std::remove(input.c_str());
+    }
+}
@@ -0,0 +1,150 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <set>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/test/Util.h"
+#include "src/extract/CNFGateFeatures.h"
+#include "src/extract/gates/GateAnalyzer.h"
+
+// clauses of o <-> (s ? t : e), whose gate is recognized by the semantic check only
+static void mux(CNFFormula& formula, unsigned o, unsigned s, unsigned t, unsigned e) {
+    formula.readClause({ Lit(o, true), Lit(s, true), Lit(t, false) });
+    formula.readClause({ Lit(o, true), Lit(s, false), Lit(e, false) });
+    formula.readClause({ Lit(o, false), Lit(s, true), Lit(t, true) });
+    formula.readClause({ Lit(o, false), Lit(s, false), Lit(e, true) });
+}
+
+/**
+ * Random circuits in n_components components with interleaved variables: each component has a few inputs and gates
+ * (and, or, xor, mux) over earlier variables, its output is a unit clause in every other component,
+ * and some random clauses remain outside of the gate structure
+ */
+static void random_circuits(CNFFormula& formula, unsigned n_components, std::uint64_t seed) {
+    XorShift64 rng(seed);
+    const unsigned size = 12;
+    std::vector<unsigned> name(n_components * size);
+    std::iota(name.begin(), name.end(), 1);
+    for (unsigned i = name.size() - 1; i > 0; --i) std::swap(name[i], name[rng(i + 1)]);
+    for (unsigned c = 0; c < n_components; ++c) {
+        auto var = [&] (unsigned i) { return name[c * size + i]; };
+        auto lit = [&] (unsigned i) { return Lit(var(i), rng(2) == 1); };
+        const unsigned n_inputs = 4;
+        for (unsigned g = n_inputs; g < size; ++g) {
+            Lit o = Lit(var(g), false);
+            Lit a = lit(rng(g)), b = lit(rng(g)), s = lit(rng(g));
+            if (a.var() == b.var() || a.var() == s.var() || b.var() == s.var()) continue;
+            switch (rng(4)) {
+                case 0:  // and
+                    formula.readClause({ ~o, a });
+                    formula.readClause({ ~o, b });
+                    formula.readClause({ o, ~a, ~b });
+                    break;
+                case 1:  // or
+                    formula.readClause({ ~o, a, b });
+                    formula.readClause({ o, ~a });
+                    formula.readClause({ o, ~b });
+                    break;
+                case 2:  // xor
+                    formula.readClause({ ~o, a, b });
+                    formula.readClause({ ~o, ~a, ~b });
+                    formula.readClause({ o, ~a, b });
+                    formula.readClause({ o, a, ~b });
+                    break;
+                default:  // mux
+                    formula.readClause({ ~o, ~s, a });
+                    formula.readClause({ ~o, s, b });
+                    formula.readClause({ o, ~s, ~a });
+                    formula.readClause({ o, s, ~b });
+            }
+        }
+        if (c % 2 == 0) formula.readClause({ Lit(var(size - 1), false) });
+        for (unsigned k = 0; k < 2; ++k) formula.readClause({ lit(rng(size)), lit(rng(size)), lit(rng(size)) });
+    }
+}
+
+// gate analysis with analyze(components, n_threads) has the same result as analyze()
+static void check_parallel(const CNFFormula& formula, unsigned max) {
+    GateAnalyzer serial(formula, true, true, max);
+    serial.analyze();
+    GateFormula expected = serial.getGateFormula();
+
+    GateAnalyzer parallel(formula, true, true, max);
+    parallel.analyze(CNFGateFeatures::components(formula), 4);
+    GateFormula actual = parallel.getGateFormula();
+
+    CHECK(actual.roots == expected.roots);
+    CHECK(actual.inputs == expected.inputs);
+    CHECK(actual.direct == expected.direct);
+    CHECK(std::set<Cl*>(actual.remainder.begin(), actual.remainder.end()) == std::set<Cl*>(expected.remainder.begin(), expected.remainder.end()));
+    REQUIRE(actual.nVars() == expected.nVars());
+    for (unsigned v = 0; v < expected.nVars(); ++v) {
+        const Gate& a = actual[Var(v)];
+        const Gate& e = expected[Var(v)];
+        CHECK(a.type == e.type);
+        CHECK(a.out == e.out);
+        CHECK(a.notMono == e.notMono);
+        CHECK(a.inp == e.inp);
+        CHECK(std::set<Cl*>(a.fwd.begin(), a.fwd.end()) == std::set<Cl*>(e.fwd.begin(), e.fwd.end()));
+        CHECK(std::set<Cl*>(a.bwd.begin(), a.bwd.end()) == std::set<Cl*>(e.bwd.begin(), e.bwd.end()));
+    }
+}
+
+TEST_CASE("GateAnalyzer") {
+    SUBCASE("semantic checks in sequence") {
+        // roots 1 <-> (3 or 4) and 2 <-> (-3 or -4) use 4 in both polarities, such that gate 4 and its input 6 are checked semantically;
+        // the unit clause which disables the clauses of the check of 4 must not leak into the first clause of the check of 6
+        CNFFormula formula;
+        formula.readClause({ Lit(1, false) });
+        formula.readClause({ Lit(2, false) });
+        formula.readClause({ Lit(1, true), Lit(3, false), Lit(4, false) });
+        formula.readClause({ Lit(1, false), Lit(3, true) });
+        formula.readClause({ Lit(1, false), Lit(4, true) });
+        formula.readClause({ Lit(2, true), Lit(3, true), Lit(4, true) });
+        formula.readClause({ Lit(2, false), Lit(3, false) });
+        formula.readClause({ Lit(2, false), Lit(4, false) });
+        mux(formula, 4, 5, 6, 7);
+        mux(formula, 6, 8, 9, 10);
+
+        GateAnalyzer analyzer(formula, true, true, 10);
+        analyzer.analyze();
+        GateFormula gates = analyzer.getGateFormula();
+        CHECK(gates[Var(4)].type == GENERIC);
+        CHECK(gates[Var(6)].type == GENERIC);
+        CHECK(gates.nGates() == 4);
+    }
+
+    SUBCASE("parallel components") {
+        for (std::uint64_t seed = 1; seed <= 20; ++seed) {
+            CNFFormula formula;
+            random_circuits(formula, 8, seed);
+            REQUIRE(CNFGateFeatures::components(formula).size() > 1);
+            check_parallel(formula, formula.nVars() / 3);
+        }
+    }
+
+    SUBCASE("parallel components with cut rounds") {
+        // components run more rounds than max in total, merge_rounds undoes those which analyze() does not select
+        for (std::uint64_t seed = 1; seed <= 20; ++seed) {
+            CNFFormula formula;
+            random_circuits(formula, 8, seed);
+            GateAnalyzer unlimited(formula, true, true, formula.nVars());
+            unlimited.analyze();
+            GateAnalyzer limited(formula, true, true, 3);
+            limited.analyze();
+            CHECK(limited.getGateFormula().nRoots() < unlimited.getGateFormula().nRoots());
+            check_parallel(formula, 3);
+        }
+    }
+}
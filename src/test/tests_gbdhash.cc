@@ -0,0 +1,67 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/test/Util.h"
+#include "src/identify/GBDHash.h"
+
+TEST_CASE("GBDHash") {
+    SUBCASE("batch equals single hashes") {
+        // more files than lanes, of very different sizes, and files which can not be parsed in between
+        std::vector<std::unique_ptr<TempPath>> temps;
+        std::vector<std::string> filenames;
+        std::vector<bool> valid;
+        XorShift64 rng(42);
+        unsigned n_files = 2 * md5::mb_lanes() + 3;
+        for (unsigned i = 0; i < n_files; ++i) {
+            temps.emplace_back(new TempPath("gbdc.test.batch." + std::to_string(i) + ".cnf"));
+            std::ofstream out(*temps.back());
+            unsigned clauses = i % 4 == 0 ? 1 : (i % 4 == 1 ? 100 : (i % 4 == 2 ? 50000 : 0));
+            out << "c file " << i << "\np cnf 1000 " << clauses << "\n";
+            for (unsigned c = 0; c < clauses; ++c) {
+                unsigned length = 1 + rng(i % 4 == 2 ? 5 : 40);
+                for (unsigned j = 0; j < length; ++j) out << (rng(2) ? "-" : "") << 1 + rng(1000) << " ";
+                out << "0\n";
+            }
+            if (i % 7 == 3) out << "1 x 0\n";
+            filenames.push_back(temps.back()->string());
+            valid.push_back(i % 7 != 3);
+        }
+        filenames.insert(filenames.begin() + 5, (std::filesystem::temp_directory_path() / "gbdc.test.batch.missing.cnf").string());
+        valid.insert(valid.begin() + 5, false);
+        filenames.push_back("src/test/resources/ibm-2004-03-k70.cnf.xz");
+        valid.push_back(true);
+        filenames.push_back("src/test/resources/test.cnf.xz");
+        valid.push_back(true);
+
+        std::vector<std::string> hashes = CNF::gbdhash_batch(filenames);
+        REQUIRE(hashes.size() == filenames.size());
+        for (unsigned i = 0; i < filenames.size(); ++i) {
+            CAPTURE(filenames[i]);
+            if (valid[i]) {
+                CHECK(hashes[i] == CNF::gbdhash(filenames[i].c_str()));
+            } else {
+                CHECK_THROWS_AS(CNF::gbdhash(filenames[i].c_str()), ParserException);
+                CHECK(hashes[i] == "");
+            }
+        }
+    }
+
+    SUBCASE("batch of one file and of none") {
+        std::vector<std::string> one { "src/test/resources/test.cnf.xz" };
+        CHECK(CNF::gbdhash_batch(one) == std::vector<std::string> { CNF::gbdhash(one[0].c_str()) });
+        CHECK(CNF::gbdhash_batch(std::vector<std::string>()).empty());
+    }
+}
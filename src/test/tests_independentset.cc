@@ -0,0 +1,102 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/test/Util.h"
+#include "src/transform/IndependentSet.h"
+
+TEST_CASE("IndependentSet") {
+    TempPath input("gbdc.test.kis.cnf");
+    TempPath output("gbdc.test.kis.out");
+    {
+        // duplicate literals are removed and the tautology is dropped, as in CNFFormula
+        std::ofstream out(input);
+        out << "c comment\np cnf 3 4\n1 -2 1 0\n2 -2 3 0\n-1 2 0\n3 0\n";
+    }
+
+    IndependentSetFromCNF gen(input.c_str());
+    CHECK(gen.numNodes() == 5);
+    CHECK(gen.numEdges() == 8);
+    CHECK(gen.minK() == 3);
+
+    gen.generate_independent_set_problem(output.c_str());
+    CHECK(read_file(output) == "c satisfiable iff maximum independent set size is 3\nc kis nNodes nEdges k\np kis 5 8 3\n"
+        "1 2 0\n2 1 0\n3 4 0\n4 3 0\n"  // cliques of clauses
+        "1 3 0\n3 1 0\n4 2 0\n2 4 0\n");  // opposite literals of variables 1 and 2
+
+    SUBCASE("graph formats") {
+        gen.generate_independent_set_problem(output.c_str(), CompressionOptions(), 1, GraphFormat::DIMACS);
+        CHECK(read_file(output) == "c satisfiable iff maximum independent set size is 3\np edge 5 4\ne 1 2\ne 3 4\ne 1 3\ne 4 2\n");
+
+        IndependentSetFromCNF metis(input.c_str());
+        metis.generate_independent_set_problem(output.c_str(), CompressionOptions(), 1, GraphFormat::METIS);
+        CHECK(read_file(output) == "% satisfiable iff maximum independent set size is 3\n5 4\n2 3\n1 4\n1 4\n2 3\n\n");
+
+        IndependentSetFromCNF csr(input.c_str());
+        csr.generate_independent_set_problem(output.c_str(), CompressionOptions(), 1, GraphFormat::CSR);
+        std::string expected = "GBDCCSR1";
+        for (uint64_t value : { 5, 4, 3, 0, 2, 4, 6, 8, 8 }) expected += std::string(reinterpret_cast<const char*>(&value), 8);
+        for (uint32_t value : { 1, 2, 0, 3, 0, 3, 1, 2 }) expected += std::string(reinterpret_cast<const char*>(&value), 4);
+        CHECK(read_file(output) == expected);
+
+        CHECK(graph_format("", "out.graph.xz") == GraphFormat::METIS);
+        CHECK(graph_format("", "out.col") == GraphFormat::DIMACS);
+        CHECK(graph_format("csr", "out.kis") == GraphFormat::CSR);
+        CHECK(graph_format("", "-") == GraphFormat::KIS);
+        CHECK_THROWS_AS(graph_format("adj"), std::invalid_argument);
+    }
+
+    SUBCASE("input changed between passes") {
+        // a variable above the ones of the first pass, and more literals than in the first pass
+        for (std::string changed : { "p cnf 3 4\n1 -2 0\n2 -7 0\n-1 2 0\n3 0\n", "p cnf 3 4\n1 -2 3 0\n2 3 0\n-1 2 -3 0\n3 1 0\n-1 -3 0\n" }) {
+            for (GraphFormat format : { GraphFormat::KIS, GraphFormat::METIS }) {
+                IndependentSetFromCNF before(input.c_str());
+                {
+                    std::ofstream out(input);
+                    out << changed;
+                }
+                CHECK_THROWS_AS(before.generate_independent_set_problem(output.c_str(), CompressionOptions(), 1, format), ParserException);
+                std::ofstream out(input);
+                out << "c comment\np cnf 3 4\n1 -2 1 0\n2 -2 3 0\n-1 2 0\n3 0\n";
+            }
+        }
+    }
+
+    SUBCASE("parallel edge generation") {
+        // a clause and a variable with more edges than one block, and many small clauses
+        {
+            std::ofstream out(input);
+            out << "p cnf 1000 3000\n";
+            for (int i = 1; i <= 400; ++i) out << i << " ";
+            out << "0\n";
+            unsigned seed = 1;
+            for (int i = 0; i < 3000; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    seed = seed * 1103515245 + 12345;
+                    int lit = 1 + (seed >> 16) % 1000;
+                    out << (i % 2 == 0 ? -1 : ((seed & 1) ? lit : -lit)) << " ";
+                }
+                out << "0\n";
+            }
+        }
+        for (GraphFormat format : { GraphFormat::KIS, GraphFormat::DIMACS, GraphFormat::METIS, GraphFormat::CSR }) {
+            IndependentSetFromCNF serial(input.c_str());
+            serial.generate_independent_set_problem(output.c_str(), CompressionOptions(), 1, format);
+            std::string expected = read_file(output);
+            IndependentSetFromCNF parallel(input.c_str());
+            parallel.generate_independent_set_problem(output.c_str(), CompressionOptions(), 4, format);
+            CHECK(parallel.numEdges() > 4 * (1 << 15));
+            CHECK(read_file(output) == expected);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/test/Util.h"
+#include "src/identify/ISOHash.h"
+
+// random instance in which all variables occur, variable 1 in every clause, and variables 2 to 8 often
+static void random_cnf(std::ostream& out, unsigned n_vars, unsigned n_clauses, std::uint64_t seed) {
+    XorShift64 rng(seed);
+    out << "c random instance\np cnf " << n_vars << " " << n_clauses + 1 << "\n";
+    for (unsigned v = 1; v <= n_vars; ++v) out << v << " ";
+    out << "0\n";
+    for (unsigned c = 0; c < n_clauses; ++c) {
+        out << (rng(2) ? "-1 " : "1 ");
+        for (unsigned j = rng(5); j > 0; --j) {
+            unsigned var = rng(4) == 0 ? 2 + rng(7) : 1 + rng(n_vars);
+            out << (rng(2) ? "-" : "") << var << " ";
+        }
+        out << "0\n";
+    }
+}
+
+TEST_CASE("ISOHash") {
+    SUBCASE("known values") {
+        // values of the implementation before radix sort and format_uint, std::sort is used below 256 nodes
+        CHECK(CNF::isohash("src/test/resources/test.cnf.xz") == "0dc7f384982e85ba44a94aca9a27974f");
+        CHECK(CNF::isohash("src/test/resources/ibm-2004-03-k70.cnf.xz") == "622daec0bc128aa45b15a6fbff728dce");
+        const unsigned sizes[][2] = { { 255, 2000 }, { 256, 2000 }, { 5000, 100000 } };
+        const char* expected[] = { "a49430fd3b8f6eac1d4de62a6829321b", "f893f713c00864372b6593af05021a06", "303270f79664af66836f9a60d767cf30" };
+        for (unsigned i = 0; i < 3; ++i) {
+            TempPath input("gbdc.test.isohash." + std::to_string(sizes[i][0]) + ".cnf");
+            {
+                std::ofstream out(input);
+                random_cnf(out, sizes[i][0], sizes[i][1], sizes[i][0]);
+            }
+            CHECK(CNF::isohash(input.c_str()) == expected[i]);
+            CHECK(CNF::isohash(input.c_str(), 4) == expected[i]);
+        }
+    }
+
+    SUBCASE("parallel counting") {
+        // several blocks of lines, with a header which pre-sizes the degree arrays to 8 MB
+        TempPath input("gbdc.test.isohash.cnf");
+        {
+            std::ofstream out(input);
+            out << "p cnf 1048576 200000\n";
+            XorShift64 rng(7);
+            for (unsigned i = 0; i < 200000; ++i) {
+                for (unsigned j = 0; j < 3; ++j) out << (rng(2) ? "-" : "") << 1 + rng(1 << 20) << " ";
+                out << "0\n";
+            }
+        }
+        std::string expected = CNF::isohash(input.c_str());
+        CHECK(CNF::isohash(input.c_str(), 4) == expected);
+        CHECK(CNF::isohash(input.c_str(), 0) == expected);
+
+        // thread-local arrays are charged to the budget of the caller
+        MemoryBudget budget(16 << 20);
+        MemoryBudgetScope scope(&budget);
+        CHECK(CNF::isohash(input.c_str(), 1) == expected);
+        CHECK_THROWS_AS(CNF::isohash(input.c_str(), 4), MemoryLimitExceeded);
+        CHECK(budget.used() == 0);
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * Some tests for gbdc
+ * 
+ * @author Markus Iser 
+ */
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "lib/md5/md5.h"
+#include "lib/md5/md5_mb.h"
+
+static std::string reference(const std::string& message) {
+    unsigned char sig[MD5_SIZE];
+    char str[MD5_STRING_SIZE];
+    md5::md5_t hasher(message.data(), message.size(), sig);
+    md5::sig_to_string(sig, str, sizeof(str));
+    return std::string(str);
+}
+
+TEST_CASE("MD5") {
+    SUBCASE("RFC 1321 test suite") {
+        CHECK(reference("") == "d41d8cd98f00b204e9800998ecf8427e");
+        CHECK(reference("abc") == "900150983cd24fb0d6963f7d28e17f72");
+        CHECK(reference("12345678901234567890123456789012345678901234567890123456789012345678901234567890") == "57edf4a22be3c955ac49da2e2107b67a");
+    }
+
+    SUBCASE("chunked input") {
+        std::mt19937 rng(1);
+        for (unsigned i = 0; i < 100; ++i) {
+            std::string message(rng() % 5000, ' ');
+            for (char& c : message) c = rng();
+            MD5 md5;
+            for (size_t pos = 0; pos < message.size(); ) {
+                size_t length = std::min<size_t>(message.size() - pos, rng() % 100 == 0 ? rng() % 3000 : rng() % 10);
+                md5.consume(message.data() + pos, length);
+                pos += length;
+            }
+            CHECK(md5.produce() == reference(message));
+        }
+    }
+
+    SUBCASE("multi-buffer lanes") {
+        std::mt19937 rng(2);
+        std::vector<std::string> messages;
+        for (unsigned i = 0; i < 50; ++i) {
+            std::string message(rng() % (i < 25 ? 200 : 20000), ' ');
+            for (char& c : message) c = rng();
+            messages.push_back(message);
+        }
+        for (unsigned lanes : { 1, 4, 8, 16 }) {
+            md5::mb_t mb(lanes);
+            std::vector<size_t> index(mb.lanes()), pos(mb.lanes());
+            size_t next = 0, finished = 0;
+            while (finished < messages.size()) {
+                for (unsigned l = 0; l < mb.lanes(); ++l) {
+                    if (!mb.busy(l) && next < messages.size()) {
+                        mb.start(l);
+                        index[l] = next++;
+                        pos[l] = 0;
+                    }
+                    if (mb.busy(l) && pos[l] < messages[index[l]].size()) {
+                        size_t length = std::min<size_t>(messages[index[l]].size() - pos[l], 64 + rng() % 2000);
+                        mb.process(l, messages[index[l]].data() + pos[l], length);
+                        pos[l] += length;
+                    }
+                    if (mb.busy(l) && pos[l] == messages[index[l]].size()) {
+                        mb.finish(l);
+                        pos[l] = messages[index[l]].size() + 1;
+                    }
+                }
+                mb.run();
+                for (unsigned l = 0; l < mb.lanes(); ++l) {
+                    if (mb.done(l)) {
+                        unsigned char sig[MD5_SIZE];
+                        char str[MD5_STRING_SIZE];
+                        mb.get_sig(l, sig);
+                        md5::sig_to_string(sig, str, sizeof(str));
+                        CHECK(std::string(str) == reference(messages[index[l]]));
+                        ++finished;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/extract/CNFSinglePass.h"
+#include "src/util/CNFFormula.h"
+#include "src/util/MemoryBudget.h"
+#include "src/util/SpillBuffer.h"
+
+TEST_CASE("MemoryBudget") {
+    SUBCASE("budget") {
+        MemoryBudget budget(100);
+        budget.charge(60);
+        CHECK_THROWS_AS(budget.charge(41), MemoryLimitExceeded);
+        CHECK(budget.used() == 60);
+        budget.charge(40);
+        budget.release(100);
+        CHECK(budget.used() == 0);
+        CHECK(budget.peak() == 100);
+    }
+
+    SUBCASE("account") {
+        MemoryBudget budget;
+        {
+            MemoryBudgetScope scope(&budget);
+            MemoryAccount account;
+            account.charge(10);
+            {
+                MemoryAccount copy(account);
+                CHECK(budget.used() == 20);
+            }
+            account.set(5);
+            CHECK(budget.used() == 5);
+        }
+        CHECK(budget.used() == 0);
+        CHECK(current_memory_budget() == nullptr);
+    }
+
+    SUBCASE("formula") {
+        std::filesystem::path input = std::filesystem::temp_directory_path() / "gbdc.test.memorybudget.cnf";
+        {
+            std::ofstream out(input);
+            out << "p cnf 100 1000\n";
+            for (int i = 0; i < 1000; ++i) out << 1 + i % 100 << " " << -(1 + (i + 1) % 100) << " 0\n";
+        }
+        MemoryBudget small(1 << 12), large(1 << 20);
+        {
+            MemoryBudgetScope scope(&small);
+            CHECK_THROWS_AS(CNFFormula(input.c_str()), MemoryLimitExceeded);
+        }
+        CHECK(small.used() == 0);
+        {
+            MemoryBudgetScope scope(&large);
+            CNFFormula formula(input.c_str());
+            CHECK(formula.nClauses() == 1000);
+            CHECK(large.used() > 0);
+            // budgets are per task, another thread without budget is not affected
+            std::thread other([&] {
+                CNFFormula formula(input.c_str());
+                CHECK(formula.nClauses() == 1000);
+            });
+            other.join();
+        }
+        CHECK(large.used() == 0);
+        std::remove(input.c_str());
+    }
+
+    SUBCASE("single pass") {
+        // long clauses, such that the copy of the literals for the second pass dominates
+        std::filesystem::path input = std::filesystem::temp_directory_path() / "gbdc.test.memorybudget.singlepass.cnf";
+        {
+            std::ofstream out(input);
+            out << "p cnf 50 5000\n";
+            for (int i = 0; i < 5000; ++i) {
+                for (int v = 1; v <= 50; ++v) out << ((i + v) % 3 == 0 ? -v : v) << " ";
+                out << "0\n";
+            }
+        }
+        MemoryBudget small(1 << 18), large(1 << 22);
+        {
+            MemoryBudgetScope scope(&small);
+            CNF::SinglePass stats(input.c_str());
+            CHECK_THROWS_AS(stats.extract(), MemoryLimitExceeded);
+        }
+        CHECK(small.used() == 0);
+        {
+            MemoryBudgetScope scope(&large);
+            CNF::SinglePass stats(input.c_str());
+            stats.extract();
+            CHECK(large.peak() >= 5000 * 50 * sizeof(Lit));
+        }
+        CHECK(large.used() == 0);
+        std::remove(input.c_str());
+    }
+}
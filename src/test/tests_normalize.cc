@@ -0,0 +1,109 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/test/Util.h"
+#include "src/transform/Normalize.h"
+
+TEST_CASE("Normalize") {
+    TempPath input("gbdc.test.normalize.cnf");
+    TempPath output("gbdc.test.normalize.out.cnf");
+    {
+        std::ofstream out(input);
+        out << "c comment\np cnf 9 9\n1 -2 1 0\n3 -3 4\n 5 0\n-4 2 0 c trailing\n6 0\n";
+    }
+
+    SUBCASE("normalize") {
+        normalize(input.c_str(), output.c_str());
+        CHECK(read_file(output) == "p cnf 6 4\n1 -2 1 0\n3 -3 4 5 0\n-4 2 0\n6 0\n");
+    }
+
+    SUBCASE("sanitize") {
+        // duplicate literals are removed, the tautology is dropped entirely
+        sanitize(input.c_str(), output.c_str());
+        CHECK(read_file(output) == "p cnf 6 3\n1 -2 0\n-4 2 0\n6 0\n");
+    }
+
+    SUBCASE("check sanitized") {
+        CHECK(!check_sanitized(input.c_str()));
+        sanitize(input.c_str(), output.c_str());
+        CHECK(check_sanitized(output.c_str()));
+        {
+            std::ofstream out(output);
+            out << "p cnf 3 2\n1 2 0\n3 -1 -3 0\n";
+        }
+        CHECK(!check_sanitized(output.c_str()));
+    }
+
+    SUBCASE("parallel sanitize") {
+        // several blocks, clauses spanning lines, tautologies and comments at block boundaries
+        std::string expected;
+        {
+            std::ofstream out(input);
+            int clauses = 0;
+            for (int i = 1; i <= 200000; ++i) {
+                int a = i % 1000 + 1, b = i % 777 + 1;
+                if (i % 5 == 0) {
+                    out << a << " -" << b << "\n" << a << " 0\n";
+                    if (a != b) {
+                        expected += std::to_string(a) + " -" + std::to_string(b) + " 0\n";
+                        ++clauses;
+                    }
+                } else if (i % 7 == 0) {
+                    out << "c " << i << " 0\n" << a << " -" << a << "\n" << b << " 0\n";
+                } else {
+                    out << "-" << a << " 0\n";
+                    expected += "-" + std::to_string(a) + " 0\n";
+                    ++clauses;
+                }
+            }
+            expected = "p cnf 1000 " + std::to_string(clauses) + "\n" + expected;
+        }
+        sanitize(input.c_str(), output.c_str(), CompressionOptions(), 4);
+        CHECK(read_file(output) == expected);
+        sanitize(input.c_str(), output.c_str(), CompressionOptions(), 1);
+        CHECK(read_file(output) == expected);
+    }
+}
+
+TEST_CASE("Clause Boundary") {
+    auto boundary = [](const std::string& text) {
+        return clause_boundary(std::vector<char>(text.begin(), text.end()));
+    };
+    CHECK(boundary("1 2 0\n3 4\n5") == 5);
+    CHECK(boundary("1 2 0\n3 10") == 5);
+    CHECK(boundary("1 2 -0 \n3") == 7);
+    CHECK(boundary("1 2 0\nc 0") == 5);
+    CHECK(boundary("1 2\n3") == 0);
+}
+
+TEST_CASE("SpillBuffer") {
+    TempPath output("gbdc.test.spill.txt");
+    std::string expected = "header\n";
+    {
+        SpillBuffer body(64);
+        std::vector<int> clause { -1, 22, -333 };
+        for (int i = 0; i < 100; ++i) {
+            body.write_clause(clause);
+            expected += "-1 22 -333 0\n";
+        }
+        body.write(std::string(100, 'x').c_str(), 100);
+        expected += std::string(100, 'x');
+        CHECK(body.spilled());
+        StreamWriter out(output.c_str());
+        out.write("header\n", 7);
+        body.copy_to(out);
+        out.close();
+    }
+    CHECK(read_file(output) == expected);
+}
@@ -0,0 +1,86 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/util/PrefetchReader.h"
+
+TEST_CASE("PrefetchReader") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "gbdc.test.prefetch";
+    std::filesystem::create_directories(dir);
+    std::vector<std::string> filenames;
+    std::vector<std::string> contents;
+    for (unsigned i = 0; i < 20; ++i) {
+        std::string content(i * 997, static_cast<char>('a' + i));
+        std::string filename = (dir / ("f" + std::to_string(i))).string();
+        std::ofstream(filename, std::ios::binary) << content;
+        filenames.push_back(filename);
+        contents.push_back(content);
+    }
+    filenames.push_back((dir / "missing").string());
+    filenames.push_back(dir.string());
+
+    SUBCASE("files in order, missing files and directories are not loaded") {
+        PrefetchReader prefetch(filenames, 3);
+        PrefetchReader::File file;
+        for (unsigned i = 0; i < 20; ++i) {
+            REQUIRE(prefetch.next(file));
+            CHECK(file.index == i);
+            CHECK(file.loaded);
+            CHECK(std::string(file.data.begin(), file.data.end()) == contents[i]);
+        }
+        REQUIRE(prefetch.next(file));
+        CHECK(!file.loaded);
+        REQUIRE(prefetch.next(file));
+        CHECK(!file.loaded);
+        CHECK(!prefetch.next(file));
+    }
+
+    SUBCASE("files larger than max_size are not loaded") {
+        PrefetchReader prefetch(filenames, 4, 10000);
+        PrefetchReader::File file;
+        for (unsigned i = 0; i < 20; ++i) {
+            REQUIRE(prefetch.next(file));
+            CHECK(file.loaded == (contents[i].size() <= 10000));
+        }
+    }
+
+    SUBCASE("loaded files are charged to the current memory budget") {
+        MemoryBudget budget(10000);
+        {
+            MemoryBudgetScope scope(&budget);
+            PrefetchReader prefetch(filenames, 4);
+            PrefetchReader::File file;
+            for (unsigned i = 0; i < 20; ++i) {
+                REQUIRE(prefetch.next(file));
+                if (contents[i].size() > 10000) CHECK(!file.loaded);
+                if (file.loaded) {
+                    CHECK(std::string(file.data.begin(), file.data.end()) == contents[i]);
+                    CHECK(file.memory.bytes() == contents[i].size());
+                    CHECK(budget.used() >= contents[i].size());
+                }
+            }
+        }
+        CHECK(budget.peak() > 0);
+        CHECK(budget.peak() <= 10000);
+        CHECK(budget.used() == 0);
+    }
+
+    SUBCASE("destruction before all files are handed out") {
+        PrefetchReader prefetch(filenames, 2);
+        PrefetchReader::File file;
+        CHECK(prefetch.next(file));
+    }
+
+    std::filesystem::remove_all(dir);
+}
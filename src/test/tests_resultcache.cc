@@ -0,0 +1,107 @@
+/**
+ * Some tests for gbdc
+ * 
+ * @author Markus Iser 
+ */
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/util/ResultCache.h"
+
+TEST_CASE("ResultCache") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "gbdc.test.cache";
+    std::filesystem::path file = std::filesystem::temp_directory_path() / "gbdc.test.cache.cnf";
+    std::filesystem::remove_all(dir);
+    {
+        std::ofstream out(file);
+        out << "p cnf 2 1\n1 -2 0\n";
+    }
+    ResultCache cache(dir.c_str());
+    CHECK(cache.enabled());
+
+    SUBCASE("store and lookup") {
+        std::string value;
+        CHECK(!cache.get(file.c_str(), "cnf.gbdhash", &value));
+        cache.put(file.c_str(), "cnf.gbdhash", "abc");
+        CHECK(cache.get(file.c_str(), "cnf.gbdhash", &value));
+        CHECK(value == "abc");
+
+        std::vector<double> record { 1.0, 0.1, 1e-300, 12345678.5 };
+        std::vector<double> cached;
+        cache.put(file.c_str(), "cnf.base_features", record);
+        CHECK(cache.get(file.c_str(), "cnf.base_features", &cached));
+        CHECK(cached == record);
+        CHECK(cache.get(file.c_str(), "cnf.gbdhash", &value));
+    }
+
+    SUBCASE("fetch computes only on miss") {
+        int calls = 0;
+        auto compute = [&calls] { ++calls; return std::string("xyz"); };
+        CHECK(cache.fetch(file.c_str(), "cnf.isohash", compute) == "xyz");
+        CHECK(cache.fetch(file.c_str(), "cnf.isohash", compute) == "xyz");
+        CHECK(calls == 1);
+    }
+
+    SUBCASE("fetch does not store results of files which changed meanwhile") {
+        auto compute = [&file] {
+            std::ofstream out(file, std::ofstream::app);
+            out << "2 0\n";
+            return std::string("old");
+        };
+        CHECK(cache.fetch(file.c_str(), "cnf.gbdhash", compute) == "old");
+        std::string value;
+        CHECK(!cache.get(file.c_str(), "cnf.gbdhash", &value));
+    }
+
+    SUBCASE("modified file invalidates entry") {
+        std::string value;
+        cache.put(file.c_str(), "cnf.gbdhash", "abc");
+        {
+            std::ofstream out(file, std::ofstream::app);
+            out << "2 0\n";
+        }
+        CHECK(!cache.get(file.c_str(), "cnf.gbdhash", &value));
+    }
+
+    SUBCASE("concurrent updates of one entry") {
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < 8; ++i) {
+            threads.emplace_back([&cache, &file, i] {
+                for (unsigned j = 0; j < 20; ++j) {
+                    std::string key = "key" + std::to_string(i) + "." + std::to_string(j);
+                    cache.put(file.c_str(), key.c_str(), std::to_string(j));
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        for (unsigned i = 0; i < 8; ++i) {
+            for (unsigned j = 0; j < 20; ++j) {
+                std::string key = "key" + std::to_string(i) + "." + std::to_string(j);
+                std::string value;
+                CHECK(cache.get(file.c_str(), key.c_str(), &value));
+                CHECK(value == std::to_string(j));
+            }
+        }
+        // one entry, no lock or temporary files
+        CHECK(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()) == 1);
+    }
+
+    SUBCASE("disabled cache") {
+        ResultCache disabled("");
+        std::string value;
+        CHECK(!disabled.enabled());
+        disabled.put(file.c_str(), "cnf.gbdhash", "abc");
+        CHECK(!disabled.get(file.c_str(), "cnf.gbdhash", &value));
+    }
+
+    std::filesystem::remove(file);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,131 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/util/JsonLine.h"
+#include "src/util/Server.h"
+
+// send the given request lines on one connection and collect the responses by id
+std::map<std::string, std::string> request(const std::string& socket, const std::string& lines) {
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket.c_str(), sizeof(address.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(::connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0);
+    REQUIRE(::send(fd, lines.data(), lines.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(lines.size()));
+    ::shutdown(fd, SHUT_WR);
+    std::string received;
+    char buffer[4096];
+    ssize_t length;
+    while ((length = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) received.append(buffer, length);
+    ::close(fd);
+    std::map<std::string, std::string> responses;
+    size_t begin = 0;
+    for (size_t end = received.find('\n'); end != std::string::npos; end = received.find('\n', begin)) {
+        JsonObject response(received.substr(begin, end - begin));
+        std::string value = response.has("result") ? response.raw("result") : "error: " + response.get_string("error");
+        responses[response.has("id") ? response.raw("id") : "none"] = value;
+        begin = end + 1;
+    }
+    return responses;
+}
+
+TEST_CASE("JsonObject") {
+    JsonObject object(" {\"id\": [1, {\"a\": null}], \"tool\": \"gbd\\\"hash\", \"file\": \"a\\u00e9\\n\", \"wallout\": 100, \"x\": -1.5e3, \"y\": true} ");
+    CHECK(object.raw("id") == "[1, {\"a\": null}]");
+    CHECK(object.get_string("tool") == "gbd\"hash");
+    CHECK(object.get_string("file") == "a\xc3\xa9\n");
+    CHECK(object.get_uint("wallout") == 100);
+    CHECK(object.get_uint("memout", 7) == 7);
+    CHECK(object.get_string("missing", "default") == "default");
+    CHECK_THROWS_AS(object.get_uint("x"), JsonError);
+    CHECK(object.get_uint("wallout", 0, 100) == 100);
+    CHECK_THROWS_AS(object.get_uint("wallout", 0, 99), JsonError);
+    CHECK_THROWS_AS(object.get_string("wallout"), JsonError);
+    CHECK(JsonObject(object.raw("id").substr(4, 11)).raw("a") == "null");
+    CHECK(JsonObject(std::string("{\"s\": ") + json_string("q\"\\\n\x01") + "}").get_string("s") == "q\"\\\n\x01");
+
+    CHECK_THROWS_AS(JsonObject("{\"a\": 1"), JsonError);
+    CHECK_THROWS_AS(JsonObject("{\"a\": 1} x"), JsonError);
+    CHECK_THROWS_AS(JsonObject("{\"a\": nope}"), JsonError);
+    CHECK_THROWS_AS(JsonObject("[1]"), JsonError);
+
+    CHECK(json_number(3) == "3");
+    CHECK(json_number(0.1) == "0.1");
+    CHECK(json_number(1.0 / 0.0) == "null");
+    CHECK(json_record({ "a", "b" }, { 1, 2.5 }) == "{\"a\": 1, \"b\": 2.5}");
+}
+
+TEST_CASE("Server") {
+    std::string socket = (std::filesystem::temp_directory_path() / ("gbdc_test_" + std::to_string(getpid()) + ".sock")).string();
+    Server server(socket, 2, [] (const JsonObject& request) {
+        std::string tool = request.get_string("tool");
+        if (tool == "echo") {
+            return json_string(request.get_string("file"));
+        } else if (tool == "spin") {
+            auto start = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+                check_cancellation();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return std::string("\"finished\"");
+        } else if (tool == "alloc") {
+            MemoryAccount account;
+            account.charge(64 << 20);
+            return std::string("\"allocated\"");
+        }
+        throw std::invalid_argument("unknown tool " + tool);
+    });
+    std::thread thread([&server] { server.run(); });
+
+    SUBCASE("responses by id") {
+        auto responses = request(socket,
+            "{\"id\": 1, \"tool\": \"echo\", \"file\": \"a.cnf\"}\n"
+            "\n"
+            "{\"id\": \"two\", \"tool\": \"spin\", \"wallout\": 20}\n"
+            "{\"id\": 3, \"tool\": \"alloc\", \"memout\": 1}\n"
+            "{\"id\": 4, \"tool\": \"alloc\"}\n"
+            "{\"id\": 5, \"tool\": \"unknown\"}\n"
+            "{\"id\": 7, \"tool\": \"echo\", \"file\": \"a.cnf\", \"timeout\": 4294967296}\n"
+            "not json\n"
+            "{\"id\": 6, \"tool\": \"echo\", \"file\": \"no newline at end\"}");
+        CHECK(responses.size() == 8);
+        CHECK(responses["1"] == "\"a.cnf\"");
+        CHECK(responses["\"two\""] == "error: timeout");
+        CHECK(responses["3"] == "error: memout");
+        CHECK(responses["4"] == "\"allocated\"");
+        CHECK(responses["5"] == "error: unknown tool unknown");
+        CHECK(responses["none"].find("error: invalid request") == 0);
+        CHECK(responses["6"] == "\"no newline at end\"");
+        CHECK(responses["7"] == "error: invalid request: member \"timeout\" must be at most 4294967295");
+    }
+
+    SUBCASE("concurrent connections") {
+        std::string lines;
+        for (unsigned i = 0; i < 100; ++i) lines += "{\"id\": " + std::to_string(i) + ", \"tool\": \"echo\", \"file\": \"f" + std::to_string(i) + "\"}\n";
+        std::map<std::string, std::string> first, second;
+        std::thread other([&] { second = request(socket, lines); });
+        first = request(socket, lines);
+        other.join();
+        CHECK(first.size() == 100);
+        CHECK(first == second);
+        CHECK(first["42"] == "\"f42\"");
+    }
+
+    server.stop();
+    thread.join();
+    CHECK(std::filesystem::exists(socket));
+}
@@ -0,0 +1,57 @@
+/**
+ * Some tests for gbdc
+ *
+ * @author Markus Iser
+ */
+
+#include <stdio.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "src/test/Util.h"
+#include "src/extract/CNFBaseFeatures.h"
+#include "src/extract/CNFSinglePass.h"
+#include "src/identify/GBDHash.h"
+#include "src/identify/ISOHash.h"
+
+// single pass has the same results as the standalone extractors
+static void check_single_pass(const char* filename) {
+    CAPTURE(filename);
+    CNF::SinglePass single(filename);
+    single.extract();
+    CHECK(single.getGBDHash() == CNF::gbdhash(filename));
+    CHECK(single.getIsoHash() == CNF::isohash(filename));
+
+    CNF::BaseFeatures base(filename);
+    base.extract();
+    CHECK(single.getNames() == base.getNames());
+    std::vector<double> expected = base.getFeatures();
+    std::vector<double> actual = single.getFeatures();
+    REQUIRE(actual.size() == expected.size());
+    for (unsigned i = 0; i < expected.size(); ++i) {
+        CAPTURE(single.getNames()[i]);
+        CHECK((actual[i] == expected[i] || (std::isnan(actual[i]) && std::isnan(expected[i]))));
+    }
+}
+
+TEST_CASE("SinglePass") {
+    SUBCASE("resources") {
+        check_single_pass("src/test/resources/test.cnf.xz");
+        check_single_pass("src/test/resources/ibm-2004-03-k70.cnf.xz");
+    }
+
+    SUBCASE("header with further fields, comments, duplicate literals, and tautologies") {
+        TempPath input("gbdc.test.singlepass.cnf");
+        {
+            std::ofstream out(input);
+            out << "c comment\np wcnf 6 7 100\n1 -2 1 0\n3 -3 4\n 5 0\nc inner comment\n-4 2 0\n6 6 6 0\n-1 -5 2 0\n  4   -6 0\n2 0\n";
+        }
+        check_single_pass(input.c_str());
+    }
+}
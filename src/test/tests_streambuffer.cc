@@ -6,6 +6,8 @@
 
 #include <stdio.h>
 #include <filesystem>
+#include <string>
+#include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
@@ -56,6 +58,46 @@ TEST_CASE("StreamBuffer") {
     }
 }
 
+TEST_CASE("StreamBuffer from memory") {
+    SUBCASE("read plain memory") {
+        const std::string text = "p cnf 2 1\n1 -2 0\n";
+        StreamBuffer reader(text.data(), text.size());
+        CHECK(reader.skipString("p cnf"));
+        CHECK(reader.skipWhitespace());
+        int num;
+        CHECK(reader.readInteger(&num));
+        CHECK(num == 2);
+    }
+
+    SUBCASE("read compressed memory equals reading the file") {
+        const char* path = "src/test/resources/test.cnf.xz";
+        std::FILE* file = fopen(path, "rb");
+        std::vector<char> data(std::filesystem::file_size(path));
+        CHECK(fread(data.data(), 1, data.size(), file) == data.size());
+        fclose(file);
+        StreamBuffer from_file(path);
+        StreamBuffer from_memory(data.data(), data.size());
+        Cl a, b;
+        while (from_file.readClause(a)) {
+            CHECK(from_memory.readClause(b));
+            CHECK(a == b);
+        }
+        CHECK(!from_memory.readClause(b));
+    }
+
+    SUBCASE("MemoryFile names are accepted as filenames while registered") {
+        const std::string text = "Hello World!";
+        std::string name;
+        {
+            MemoryFile memory(text.data(), text.size());
+            name = memory.name();
+            StreamBuffer reader(memory.name());
+            CHECK(reader.skipString("Hello"));
+        }
+        CHECK_THROWS_AS(StreamBuffer reader(name.c_str()), ParserException);
+    }
+}
+
 // int main() {
 //     return 0;
 // }
\ No newline at end of file
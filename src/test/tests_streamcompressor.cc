@@ -34,6 +34,59 @@ TEST_CASE("StreamCompressor")
         remove(tmp_file);
     }
 
+    SUBCASE("Write stream of unknown length")
+    {
+        for (const char *ext : {".cnf.xz", ".cnf.zst", ".cnf.gz", ".cnf"})
+        {
+            std::string tmp_file = std::string(std::tmpnam(nullptr)) + ext;
+            StreamCompressor c(tmp_file.c_str());
+            c.write("p cnf 3 1000\n", 13);
+            for (int i = 0; i < 1000; ++i)
+                c.write("1 -2 3 0\n", 9);
+            c.close();
+            StreamBuffer b(tmp_file.c_str());
+            Cl clause;
+            Cl expected = {Lit(1, false), Lit(2, true), Lit(3, false)};
+            int n = 0;
+            for (; b.readClause(clause); ++n)
+            {
+                CHECK(clause == expected);
+            }
+            CHECK(n == 1000);
+            remove(tmp_file.c_str());
+        }
+    }
+
+    SUBCASE("Write with explicit compression options")
+    {
+        for (const char *filter : {"xz", "zstd", "gzip", "none"})
+        {
+            std::string tmp_file = std::string(std::tmpnam(nullptr)) + ".cnf";
+            CompressionOptions options;
+            options.filter = filter;
+            options.level = 1;
+            options.threads = 2;
+            StreamCompressor c(tmp_file.c_str(), 0, options);
+            c.write("p cnf 3 1000\n", 13);
+            for (int i = 0; i < 1000; ++i)
+                c.write("1 -2 3 0\n", 9);
+            c.close();
+            StreamBuffer b(tmp_file.c_str());
+            Cl clause;
+            Cl expected = {Lit(1, false), Lit(2, true), Lit(3, false)};
+            int n = 0;
+            for (; b.readClause(clause); ++n)
+            {
+                CHECK(clause == expected);
+            }
+            CHECK(n == 1000);
+            remove(tmp_file.c_str());
+        }
+        CompressionOptions unknown;
+        unknown.filter = "rar";
+        CHECK_THROWS_AS(StreamCompressor(std::tmpnam(nullptr), 0, unknown), StreamCompressorException);
+    }
+
     SUBCASE("Write from istream to archive")
     {
         const char *tmp_file = strcat(tmpnam(nullptr), ".cnf.xz");
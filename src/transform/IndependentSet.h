@@ -20,96 +20,568 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef SRC_TRANSFORM_INDEPENDENTSET_H_
 #define SRC_TRANSFORM_INDEPENDENTSET_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
-#include <fstream>
-#include <memory>
 
 #include "src/util/ResourceLimits.h"
-#include "src/util/CNFFormula.h"
+#include "src/util/MemoryBudget.h"
+#include "src/util/NumberFormat.h"
+#include "src/util/SolverTypes.h"
+#include "src/util/StreamBuffer.h"
+#include "src/util/StreamWriter.h"
+#include "src/util/WorkQueue.h"
 
+/**
+ * Encodings of the generated graph:
+ * KIS lists each edge twice as "a b 0" after the header "p kis nodes 2*edges k",
+ * DIMACS lists each edge once as "e a b" after the header "p edge nodes edges",
+ * METIS lists the sorted neighbors of node i in line i after the header "nodes edges",
+ * CSR is binary: magic "GBDCCSR1", nodes, edges, k, nodes+1 offsets (all 64-bit), and the neighbors of all nodes (32-bit),
+ * where node ids are 0-based and integers are little-endian.
+ * Node ids in the text formats are 1-based.
+ */
+enum class GraphFormat { KIS, DIMACS, METIS, CSR };
+
+/**
+ * @brief graph format by name (kis, dimacs, metis, csr), empty: by extension of path
+ * (.dimacs and .col: DIMACS, .graph and .metis: METIS, .csr: CSR, otherwise KIS, compression extensions are skipped)
+ * @throw std::invalid_argument for unknown names
+ */
+inline GraphFormat graph_format(const std::string& name, const std::string& path = "") {
+    std::string format = name;
+    if (format.empty()) {
+        std::filesystem::path p(path);
+        std::string ext = p.extension();
+        if (ext == ".xz" || ext == ".lzma" || ext == ".bz2" || ext == ".gz" || ext == ".zst") ext = p.stem().extension();
+        if (ext == ".dimacs" || ext == ".col") format = "dimacs";
+        else if (ext == ".graph" || ext == ".metis") format = "metis";
+        else if (ext == ".csr") format = "csr";
+        else format = "kis";
+    }
+    if (format == "kis") return GraphFormat::KIS;
+    if (format == "dimacs") return GraphFormat::DIMACS;
+    if (format == "metis") return GraphFormat::METIS;
+    if (format == "csr") return GraphFormat::CSR;
+    throw std::invalid_argument("Unknown graph format: " + name);
+}
+
+/**
+ * Generates the independent set problem of a CNF formula in two streaming passes over the input, without loading the formula:
+ * the first pass counts nodes, edges, and occurrences per literal, the second pass emits the clique of each clause
+ * and fills a compact index of the nodes per literal (CSR), from which the edges between opposite literals are emitted.
+ * Clauses are read as by CNFFormula (sorted, without duplicate literals, tautologies removed), such that node ids are the same.
+ * Edges are formatted by several threads and written in the same order as by one thread.
+ * Adjacency formats (METIS, CSR) additionally index the literal and clause of each node in the second pass,
+ * and emit the neighbors of each node from the indexes.
+ */
 class IndependentSetFromCNF {
  private:
-    CNFFormula F;
-    std::vector<std::vector<unsigned>> literal2nodes;
+    std::string filename;
+    std::vector<uint64_t> offsets;  // nodes of literal lit are nodes[offsets[lit]] ... nodes[offsets[lit+1]-1]
+    std::vector<unsigned> nodes;
+    std::vector<unsigned> node_lits;  // literal of node i+1, adjacency formats only
+    std::vector<unsigned> clause_starts;  // first node of each clause and nNodes+1, adjacency formats only
+    MemoryAccount memory;
 
-    unsigned nNodes;
-    unsigned nEdges;
-    unsigned k;
+    unsigned nVars;
+    uint64_t nNodes;
+    uint64_t nEdges;
+    uint64_t k;
+    GraphFormat format;
+
+    // sort, remove duplicate literals, false for tautologies
+    static bool normalize(Cl& clause) {
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        for (unsigned i = 1; i < clause.size(); i++) {
+            if (clause[i - 1].var() == clause[i].var()) return false;
+        }
+        return true;
+    }
+
+    template <typename Visitor>
+    void for_each_clause(Visitor visit) const {
+        StreamBuffer in(filename.c_str());
+        Cl clause;
+        while (in.skipWhitespace()) {
+            if (*in == 'p' || *in == 'c') {
+                if (!in.skipLine()) break;
+            } else {
+                int plit;
+                while (in.readInteger(&plit)) {
+                    if (plit == 0) break;
+                    clause.push_back(Lit(abs(plit), plit < 0));
+                }
+                if (normalize(clause)) visit(clause);
+                clause.clear();
+            }
+        }
+    }
 
  public:
-    explicit IndependentSetFromCNF(const char* filename) : F(), literal2nodes(), nNodes(0), nEdges(0) {
-        F.readDimacsFromFile(filename);
-        literal2nodes.resize(2 * F.nVars() + 2);
-        unsigned nodeId = 1;
-        for (Cl* clause : F) {
-            nNodes += clause->size();  // one node per literal occurence
-            nEdges += (clause->size() * (clause->size() - 1)) / 2;  // number of edges in clique
-            for (unsigned i = 0; i < clause->size(); i++) {
-                literal2nodes[(*clause)[i]].push_back(nodeId + i);  // remember nodeids of literals
+    explicit IndependentSetFromCNF(const char* filename)
+     : filename(filename), offsets(), nodes(), node_lits(), clause_starts(), memory(), nVars(0), nNodes(0), nEdges(0), k(0), format(GraphFormat::KIS) {
+        // offsets[lit+1] counts the occurrences of lit until the end of the first pass
+        for_each_clause([&] (const Cl& clause) {
+            nNodes += clause.size();  // one node per literal occurence
+            nEdges += (static_cast<uint64_t>(clause.size()) * (clause.size() - 1)) / 2;  // number of edges in clique
+            if (clause.size() > 0 && clause.back().var().id > nVars) {
+                nVars = clause.back().var().id;
+                if (2 * nVars + 3 > offsets.size()) {
+                    size_t size = std::max<size_t>(2 * nVars + 3, 2 * offsets.size());
+                    memory.set(size * sizeof(uint64_t));
+                    offsets.resize(size);
+                }
             }
-            nodeId += clause->size();
+            for (Lit lit : clause) offsets[lit + 1]++;
+            k++;
+        });
+        if (nNodes >= std::numeric_limits<unsigned>::max()) {
+            throw std::overflow_error("Too many literal occurrences for cnf2kis: " + std::to_string(nNodes));
         }
-        for (unsigned i = 1; i <= F.nVars(); i++) {  // count edges between nodes for opposite literals
-            nEdges += literal2nodes[Lit(Var(i), false)].size() * literal2nodes[Lit(Var(i), true)].size();
+        offsets.resize(2 * nVars + 3);
+        for (unsigned i = 1; i <= nVars; i++) {  // count edges between nodes for opposite literals
+            nEdges += offsets[Lit(Var(i), false) + 1] * offsets[Lit(Var(i), true) + 1];
         }
         nEdges *= 2;  // account for reflexivity
-        k = F.nClauses();
+        for (size_t i = 1; i < offsets.size(); i++) offsets[i] += offsets[i - 1];
     }
 
-    unsigned numNodes() {
+    uint64_t numNodes() {
         return nNodes;
     }
 
-    unsigned numEdges() {
+    /**
+     * @brief number of edges, where each undirected edge counts twice (as in the header of KIS)
+     */
+    uint64_t numEdges() {
         return nEdges;
     }
 
-    unsigned minK() {
+    uint64_t minK() {
         return k;
     }
 
-    void generate_independent_set_problem(const char* output = nullptr) {
-        std::shared_ptr<std::ostream> of;
-        if (output != nullptr) {
-            of.reset(new std::ofstream(output, std::ofstream::out));
+    /**
+     * @param output path of output file (compressed by extension), nullptr or "-" for stdout
+     * @param options compression settings
+     * @param n_threads number of threads which format edges, 1: serial (default), 0: one per core (up to 8)
+     * @param graph encoding of the graph
+     */
+    void generate_independent_set_problem(const char* output = nullptr, const CompressionOptions& options = CompressionOptions(), unsigned n_threads = 1,
+            GraphFormat graph = GraphFormat::KIS) {
+        format = graph;
+        bool adjacency = format == GraphFormat::METIS || format == GraphFormat::CSR;
+        memory.charge((adjacency ? 2 * nNodes + k + 1 : nNodes) * sizeof(unsigned));
+        nodes.resize(nNodes);
+
+        StreamWriter out(output, options);
+        write_header(out);
+
+        if (n_threads == 0) n_threads = num_workers();
+        if (adjacency) {
+            index_nodes();
+            generate_adjacency(out, nEdges < 2 * pairs_per_block ? 1 : n_threads);
+        } else if (n_threads == 1 || nEdges < 2 * pairs_per_block) {
+            generate_edges(out);
         } else {
-            of.reset(&std::cout, [](...){});
+            generate_edges(out, n_threads);
         }
 
-        *of << "c satisfiable iff maximum independent set size is " << k << std::endl;
-        *of << "c kis nNodes nEdges k" << std::endl;
-        *of << "p kis " << nNodes << " " << nEdges << " " << k << std::endl;
+        out.close();
+    }
+
+ private:
+    static constexpr uint64_t pairs_per_block = 1 << 15;
+
+    // rows [begin, end) of the clique of the clause with nodes node, ..., node + size - 1
+    struct CliqueRows {
+        unsigned node, size, begin, end;
+    };
+
+    // edges of the positive occurrences [begin, end) in nodes of var to all its negative occurrences
+    struct ConflictRows {
+        unsigned var;
+        uint64_t begin, end;
+    };
+
+    struct EdgeBlock {
+        std::vector<CliqueRows> cliques;
+        std::vector<ConflictRows> conflicts;
+        uint64_t pairs = 0;
+    };
+
+    // neighbors of the nodes [begin, end)
+    struct NodeBlock {
+        unsigned begin, end;
+    };
 
+    static void put_le64(StreamWriter& out, uint64_t value) {
+        char bytes[8];
+        for (unsigned i = 0; i < 8; i++) bytes[i] = static_cast<char>(value >> (8 * i));
+        out.write(bytes, 8);
+    }
+
+    void write_header(StreamWriter& out) {
+        if (format == GraphFormat::CSR) {
+            out.write("GBDCCSR1");
+            put_le64(out, nNodes);
+            put_le64(out, nEdges / 2);
+            put_le64(out, k);
+            return;
+        }
+        out.write(format == GraphFormat::METIS ? "% " : "c ");
+        out.write("satisfiable iff maximum independent set size is ");
+        out.write_uint(k);
+        if (format == GraphFormat::KIS) {
+            out.write("\nc kis nNodes nEdges k\np kis ");
+            out.write_uint(nNodes);
+            out.put(' ');
+            out.write_uint(nEdges);
+            out.put(' ');
+            out.write_uint(k);
+        } else if (format == GraphFormat::DIMACS) {
+            out.write("\np edge ");
+            out.write_uint(nNodes);
+            out.put(' ');
+            out.write_uint(nEdges / 2);
+        } else {
+            out.put('\n');
+            out.write_uint(nNodes);
+            out.put(' ');
+            out.write_uint(nEdges / 2);
+        }
+        out.put('\n');
+    }
+
+    // clause of the second pass which starts at nodeId must fit in the index of the first pass
+    void check_clause(const Cl& clause, unsigned nodeId) const {
+        if ((clause.size() > 0 && clause.back().var().id > nVars) || nodeId + clause.size() - 1 > nNodes) {
+            throw ParserException("Input changed between passes: " + filename);
+        }
+    }
+
+    // fill nodes, where offsets[lit] is the next free position of lit, then restore offsets[lit] as start of lit
+    void index_node(Lit lit, unsigned node) {
+        if (offsets[lit] >= nNodes) throw ParserException("Input changed between passes: " + filename);
+        nodes[offsets[lit]++] = node;
+    }
+
+    void finish_index(unsigned nodeId) {
+        if (nodeId - 1 != nNodes) throw ParserException("Input changed between passes: " + filename);
+        for (size_t i = offsets.size() - 1; i > 0; i--) offsets[i] = offsets[i - 1];
+        offsets[0] = 0;
+    }
+
+    // second pass for adjacency formats, without output
+    void index_nodes() {
+        node_lits.resize(nNodes);
+        clause_starts.reserve(k + 1);
+        unsigned nodeId = 1;
+        for_each_clause([&] (const Cl& clause) {
+            check_clause(clause, nodeId);
+            clause_starts.push_back(nodeId);
+            for (unsigned i = 0; i < clause.size(); i++) {
+                index_node(clause[i], nodeId + i);
+                node_lits[nodeId + i - 1] = clause[i];
+            }
+            nodeId += clause.size();
+        });
+        clause_starts.push_back(nodeId);
+        if (clause_starts.size() != k + 1) throw ParserException("Input changed between passes: " + filename);
+        finish_index(nodeId);
+    }
+
+    uint64_t degree(unsigned node, unsigned clause) const {
+        unsigned opposite = node_lits[node - 1] ^ 1;
+        return clause_starts[clause + 1] - clause_starts[clause] - 1 + offsets[opposite + 1] - offsets[opposite];
+    }
+
+    void write_edge(StreamWriter& out, unsigned a, unsigned b) {
+        if (format == GraphFormat::DIMACS) {
+            out.write("e ", 2);
+            out.write_uint(a);
+            out.put(' ');
+            out.write_uint(b);
+            out.put('\n');
+        } else {
+            out.write_pair(a, b);
+            out.write_pair(b, a);
+        }
+    }
+
+    void generate_edges(StreamWriter& out) {
         // generate cliques
         unsigned nodeId = 1;
-        for (Cl* clause : F) {
-            for (unsigned i = 0; i < clause->size(); i++) {
+        for_each_clause([&] (const Cl& clause) {
+            check_clause(clause, nodeId);
+            for (unsigned i = 0; i < clause.size(); i++) {
                 unsigned var1 = nodeId + i;
-                for (unsigned j = i + 1; j < clause->size(); j++) {
-                    unsigned var2 = nodeId + j;
-                    *of << var1 << " " << var2 << " 0" << std::endl;
-                    *of << var2 << " " << var1 << " 0" << std::endl;
+                for (unsigned j = i + 1; j < clause.size(); j++) {
+                    write_edge(out, var1, nodeId + j);
                 }
+                index_node(clause[i], var1);
             }
-            if (of->bad()) {
-                throw FileSizeLimitExceeded();
+            nodeId += clause.size();
+        });
+        finish_index(nodeId);
+
+        // generate edges between nodes for opposite literals
+        for (unsigned i = 1; 2 * i + 2 < offsets.size(); i++) {
+            unsigned pos = Lit(Var(i), false), neg = Lit(Var(i), true);
+            for (uint64_t a = offsets[pos]; a < offsets[pos + 1]; a++) {
+                for (uint64_t b = offsets[neg]; b < offsets[neg + 1]; b++) {
+                    write_edge(out, nodes[a], nodes[b]);
+                }
             }
-            nodeId += clause->size();
         }
+    }
 
-        // generate edges between nodes for opposite literals
-        for (unsigned i = 1; i <= F.nVars(); i++) {
-            for (unsigned node1 : literal2nodes[Lit(Var(i), false)]) {
-                for (unsigned node2 : literal2nodes[Lit(Var(i), true)]) {
-                    *of << node1 << " " << node2 << " 0" << std::endl;
-                    *of << node2 << " " << node1 << " 0" << std::endl;
+    void format_block(const EdgeBlock& block, std::vector<char>& text) const {
+        text.resize(block.pairs * 2 * (2 * count_digits(nNodes) + 4));  // lines "a b 0\n" or "e a b\n"
+        char* out = text.data();
+        bool dimacs = format == GraphFormat::DIMACS;
+        auto write_edge = [&out, dimacs] (unsigned a, unsigned b) {
+            if (dimacs) {
+                std::memcpy(out, "e ", 2);
+                out += 2;
+                out += format_uint(out, a);
+                *out++ = ' ';
+                out += format_uint(out, b);
+                *out++ = '\n';
+                return;
+            }
+            out += format_uint(out, a);
+            *out++ = ' ';
+            out += format_uint(out, b);
+            std::memcpy(out, " 0\n", 3);
+            out += 3;
+            out += format_uint(out, b);
+            *out++ = ' ';
+            out += format_uint(out, a);
+            std::memcpy(out, " 0\n", 3);
+            out += 3;
+        };
+        for (const CliqueRows& rows : block.cliques) {
+            for (unsigned i = rows.begin; i < rows.end; i++) {
+                for (unsigned j = i + 1; j < rows.size; j++) {
+                    write_edge(rows.node + i, rows.node + j);
+                }
+            }
+        }
+        for (const ConflictRows& rows : block.conflicts) {
+            unsigned neg = Lit(Var(rows.var), true);
+            for (uint64_t a = rows.begin; a < rows.end; a++) {
+                for (uint64_t b = offsets[neg]; b < offsets[neg + 1]; b++) {
+                    write_edge(nodes[a], nodes[b]);
+                }
+            }
+        }
+        text.resize(out - text.data());
+    }
+
+    // sorted neighbors of each node: the other nodes of its clause merged with the nodes of the opposite literal
+    template <typename Emit>
+    void for_each_neighbor(unsigned node, unsigned clause, Emit emit) const {
+        unsigned opposite = node_lits[node - 1] ^ 1;
+        const unsigned* other = nodes.data() + offsets[opposite];
+        const unsigned* other_end = nodes.data() + offsets[opposite + 1];
+        for (unsigned neighbor = clause_starts[clause]; neighbor < clause_starts[clause + 1]; neighbor++) {
+            if (neighbor == node) continue;
+            while (other != other_end && *other < neighbor) emit(*other++);
+            emit(neighbor);
+        }
+        while (other != other_end) emit(*other++);
+    }
+
+    void format_block(const NodeBlock& block, std::vector<char>& text) const {
+        unsigned clause = std::upper_bound(clause_starts.begin(), clause_starts.end(), block.begin) - clause_starts.begin() - 1;
+        uint64_t size = 0;
+        for (unsigned node = block.begin, c = clause; node < block.end; node++) {
+            while (clause_starts[c + 1] <= node) c++;
+            size += degree(node, c);
+        }
+        char* out;
+        if (format == GraphFormat::CSR) {
+            text.resize(4 * size);
+            out = text.data();
+        } else {
+            text.resize(size * (count_digits(nNodes) + 1) + (block.end - block.begin));
+            out = text.data();
+        }
+        for (unsigned node = block.begin; node < block.end; node++) {
+            while (clause_starts[clause + 1] <= node) clause++;
+            if (format == GraphFormat::CSR) {
+                for_each_neighbor(node, clause, [&out] (unsigned neighbor) {
+                    unsigned id = neighbor - 1;
+                    for (unsigned i = 0; i < 4; i++) *out++ = static_cast<char>(id >> (8 * i));
+                });
+            } else {
+                char* line = out;
+                for_each_neighbor(node, clause, [&out] (unsigned neighbor) {
+                    out += format_uint(out, neighbor);
+                    *out++ = ' ';
+                });
+                if (out != line) out--;  // no trailing space
+                *out++ = '\n';
+            }
+        }
+        text.resize(out - text.data());
+    }
+
+    /**
+     * @brief format blocks on n_threads worker threads and write them in order from a writer thread
+     * @param produce called by the calling thread with a function which queues the next block (and returns false if generation failed)
+     */
+    template <typename Block, typename Produce>
+    void format_in_order(StreamWriter& out, unsigned n_threads, Produce produce) {
+        if (n_threads == 1) {
+            std::vector<char> text;
+            produce([&] (Block&& block) {
+                format_block(block, text);
+                out.write(text.data(), text.size());
+                return true;
+            });
+            return;
+        }
+        WorkQueue<std::pair<size_t, Block>> queue(2 * n_threads);
+        OrderedQueue<std::vector<char>> results(2 * n_threads);
+        std::vector<std::exception_ptr> errors(n_threads + 1);
+        CancellationToken* token = current_cancellation_token();
+        auto fail = [&](unsigned i) {
+            errors[i] = std::current_exception();
+            queue.close();
+            results.close();
+        };
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < n_threads; ++i) {
+            workers.emplace_back([&, i] {
+                CancellationScope scope(token);
+                std::pair<size_t, Block> work;
+                try {
+                    while (queue.pop(work)) {
+                        check_cancellation();
+                        std::vector<char> text;
+                        format_block(work.second, text);
+                        if (!results.push(work.first, std::move(text))) break;
+                    }
+                } catch (...) {
+                    fail(i);
                 }
+            });
+        }
+        std::thread writer([&] {
+            CancellationScope scope(token);
+            std::vector<char> text;
+            try {
+                while (results.pop(text)) out.write(text.data(), text.size());
+            } catch (...) {
+                fail(n_threads);
             }
-            if (of->bad()) {
-                throw FileSizeLimitExceeded();
+        });
+        auto join = [&] {
+            queue.close();
+            for (std::thread& worker : workers) worker.join();
+            results.close();
+            writer.join();
+        };
+        try {
+            size_t seq = 0;
+            produce([&] (Block&& block) {
+                return queue.push(std::make_pair(seq++, std::move(block)));
+            });
+        } catch (...) {
+            results.close();
+            join();
+            throw;
+        }
+        join();
+        for (std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * The edges are split into blocks of about pairs_per_block pairs (large cliques and variables by rows).
+     * The second pass over the input is done by the calling thread, which also fills the node index meanwhile.
+     * Blocks of edges between opposite literals are queued once the index is complete.
+     */
+    void generate_edges(StreamWriter& out, unsigned n_threads) {
+        format_in_order<EdgeBlock>(out, n_threads, [&] (auto push) {
+            EdgeBlock block;
+            auto next = [&] {
+                if (!push(std::move(block))) return false;
+                block = EdgeBlock();
+                return true;
+            };
+
+            unsigned nodeId = 1;
+            bool ok = true;
+            for_each_clause([&] (const Cl& clause) {
+                check_clause(clause, nodeId);
+                unsigned size = clause.size();
+                for (unsigned i = 0; ok && i + 1 < size; ) {
+                    unsigned begin = i;
+                    for (; i + 1 < size && block.pairs < pairs_per_block; i++) block.pairs += size - 1 - i;
+                    block.cliques.push_back({ nodeId, size, begin, i });
+                    if (block.pairs >= pairs_per_block) ok = next();
+                }
+                for (unsigned i = 0; i < size; i++) index_node(clause[i], nodeId + i);
+                nodeId += size;
+            });
+            if (!ok) return;
+            finish_index(nodeId);
+
+            for (unsigned v = 1; ok && 2 * v + 2 < offsets.size(); v++) {
+                unsigned pos = Lit(Var(v), false), neg = Lit(Var(v), true);
+                uint64_t n_neg = offsets[neg + 1] - offsets[neg];
+                if (n_neg == 0) continue;
+                for (uint64_t a = offsets[pos]; ok && a < offsets[pos + 1]; ) {
+                    uint64_t begin = a;
+                    for (; a < offsets[pos + 1] && block.pairs < pairs_per_block; a++) block.pairs += n_neg;
+                    block.conflicts.push_back({ v, begin, a });
+                    if (block.pairs >= pairs_per_block) ok = next();
+                }
+            }
+            if (ok && block.pairs > 0) next();
+        });
+    }
+
+    // neighbors of all nodes in blocks of about 2 * pairs_per_block neighbors, preceded by the offsets for CSR
+    void generate_adjacency(StreamWriter& out, unsigned n_threads) {
+        if (format == GraphFormat::CSR) {
+            uint64_t offset = 0;
+            put_le64(out, offset);
+            for (unsigned node = 1, clause = 0; node <= nNodes; node++) {
+                while (clause_starts[clause + 1] <= node) clause++;
+                offset += degree(node, clause);
+                put_le64(out, offset);
             }
         }
+        format_in_order<NodeBlock>(out, n_threads, [&] (auto push) {
+            uint64_t size = 0;
+            unsigned begin = 1;
+            for (unsigned node = 1, clause = 0; node <= nNodes; node++) {
+                while (clause_starts[clause + 1] <= node) clause++;
+                size += degree(node, clause) + 1;
+                if (size >= 2 * pairs_per_block) {
+                    if (!push(NodeBlock { begin, node + 1 })) return;
+                    begin = node + 1;
+                    size = 0;
+                }
+            }
+            if (begin <= nNodes) push(NodeBlock { begin, static_cast<unsigned>(nNodes + 1) });
+        });
     }
 };
 
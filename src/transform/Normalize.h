@@ -20,42 +20,43 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef SRC_TRANSFORM_NORMALIZE_H_
 #define SRC_TRANSFORM_NORMALIZE_H_
 
-#include <vector>
 #include <algorithm>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "src/util/Cancellation.h"
+#include "src/util/SpillBuffer.h"
+#include "src/util/Stamp.h"
 #include "src/util/StreamBuffer.h"
+#include "src/util/StreamWriter.h"
+#include "src/util/WorkQueue.h"
 
 
-void determine_counts(const char* filename, int& nvars, int& nclauses) {
-    StreamBuffer in(filename);
-    nvars = 0; 
-    nclauses = 0;
-    while (in.skipWhitespace()) {
-        if (*in == 'c' || *in == 'p') {
-            if (!in.skipLine()) break;
-        } else {
-            int plit;
-            while (in.readInteger(&plit)) {
-                if (plit == 0) break;
-                nvars = std::max(abs(plit), nvars);
-            }
-            nclauses++;
-        }
-    }
+void write_header(StreamWriter& out, int vars, int clauses) {
+    out.write("p cnf ", 6);
+    out.write_int(vars);
+    out.put(' ');
+    out.write_int(clauses);
+    out.put('\n');
 }
 
 /**
  * @brief Normalizes a CNF formula by removing comments and 
  * generating a header based on the real number of clauses
  * and the maximum variable index.
+ * The input is read only once, clauses are held in a SpillBuffer until the header is known.
  * 
  * @param filename 
+ * @param output path of output file (compressed by extension), nullptr or "-" for stdout
+ * @param options compression settings
  */
-void normalize(const char* filename) {
+void normalize(const char* filename, const char* output = nullptr, const CompressionOptions& options = CompressionOptions()) {
     StreamBuffer in(filename);
-    int vars, clauses;
-    determine_counts(filename, vars, clauses);
-    std::cout << "p cnf " << vars << " " << clauses << std::endl;
+    SpillBuffer body;
+    int vars = 0, clauses = 0;
     while (in.skipWhitespace()) {
         if (*in == 'c' || *in == 'p') {
             if (!in.skipLine()) break;
@@ -63,65 +64,257 @@ void normalize(const char* filename) {
             int plit;
             while (in.readInteger(&plit)) {
                 if (plit == 0) break;
-                std::cout << plit << " ";
+                vars = std::max(abs(plit), vars);
+                body.write_int(plit);
+                body.put(' ');
             }
-            std::cout << "0" << std::endl;
+            body.write("0\n", 2);
+            clauses++;
         }
     }
+    StreamWriter out(output, options);
+    write_header(out, vars, clauses);
+    body.copy_to(out);
+    out.close();
 }
 
 /**
- * @brief Sanitizes a CNF formula by removing comments and generating a normalized header.
- * Removes duplicate literals from clauses and removes tautological clauses while preserving
- * the order of clauses and literals.
- * 
- * @param filename
+ * @brief Find end of last line in block which terminates a clause, i.e., a non-comment line whose last token is 0
+ * @return position after that line, 0 if there is none
  */
-void sanitize(const char* filename) {
-    StreamBuffer in(filename);
+size_t clause_boundary(const std::vector<char>& block) {
+    size_t end = block.size();
+    while (end > 0) {
+        size_t begin = end;
+        while (begin > 0 && block[begin - 1] != '\n') --begin;
+        size_t first = begin;
+        while (first < end && isspace(block[first])) ++first;
+        if (first < end && block[first] != 'c' && block[first] != 'p') {
+            size_t last = end;
+            while (last > first && isspace(block[last - 1])) --last;
+            size_t token = last;
+            while (token > first && block[token - 1] == '0') --token;
+            if (token < last) {
+                if (token > first && (block[token - 1] == '-' || block[token - 1] == '+')) --token;
+                if (token == first || isspace(block[token - 1])) return end;
+            }
+        }
+        if (begin == 0) break;
+        end = begin - 1;
+    }
+    return 0;
+}
 
-    int vars, clauses;
-    determine_counts(filename, vars, clauses);
-    std::cout << "p cnf " << vars << " " << clauses << std::endl;
+/**
+ * @brief read block of complete clauses, at least size bytes (unless eof is reached)
+ * @param block the read block, output parameter
+ * @param rest remainder of the last read lines after the clause boundary, carried over to the next call
+ * @return true if block was read, false if eof was already reached
+ */
+bool read_clauses(StreamBuffer& in, std::vector<char>& block, std::vector<char>& rest, size_t size) {
+    block.swap(rest);
+    rest.clear();
+    std::vector<char> lines;
+    while (in.readLines(lines, size)) {
+        block.insert(block.end(), lines.begin(), lines.end());
+        size_t cut = clause_boundary(block);
+        if (cut > 0) {
+            rest.assign(block.begin() + cut, block.end());
+            block.resize(cut);
+            return true;
+        }
+    }
+    return !block.empty();
+}
 
-    // set mask[lit] to clause number if lit is present in clause
-    int* mask = (int*)calloc(2*vars + 2, sizeof(int));
-    mask += vars + 1;
+struct SanitizedBlock {
+    std::vector<char> text;
+    int vars = 0;
+    int clauses = 0;
+};
 
-    std::vector<int> clause;
-    unsigned stamp = 0;
-    while (in.skipWhitespace()) {
-        if (*in == 'c' || *in == 'p') {
-            if (!in.skipLine()) break;
-        } else {
-            ++stamp;
-            bool tautological = false;
-            int plit;
-            while (in.readInteger(&plit)) {
-                if (plit == 0) break;
-                if (mask[-plit] == stamp) {
-                    tautological = true;
-                    break;
-                }
-                else if (mask[plit] != stamp) {
-                    mask[plit] = stamp;
-                    clause.push_back(plit);
+/**
+ * @brief Sanitize a block of complete clauses in DIMACS format
+ * @param seen literal stamps, indexed by 2 * var + sign, grown on demand
+ * @param result sanitized clauses, maximum variable index and number of clauses, output parameter
+ */
+void sanitize_block(const std::vector<char>& block, Stamp<unsigned>& seen, SanitizedBlock& result, const char* filename) {
+    std::vector<char>& text = result.text;
+    text.resize(block.size() + 64);
+    size_t pos = 0;
+    result.vars = 0;
+    result.clauses = 0;
+
+    size_t clause_start = 0;
+    bool in_clause = false;
+    bool tautological = false;
+    const char* p = block.data();
+    const char* end = p + block.size();
+    while (true) {
+        while (p < end && isspace(*p)) ++p;
+        bool terminate = p == end;  // clause without trailing 0 at end of file
+        uint64_t var = 0;
+        bool negative = false;
+        if (!terminate) {
+            const char c = *p;
+            if (!in_clause && (c == 'c' || c == 'p')) {
+                const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+                p = eol == nullptr ? end : eol;
+                continue;
+            }
+            negative = c == '-';
+            if (c == '-' || c == '+') ++p;
+            if (p == end || !isdigit(*p)) {
+                throw ParserException(std::string(filename) + ": unexpected character: " + c);
+            }
+            while (p < end && isdigit(*p)) {
+                var = 10 * var + (*p - '0');
+                if (var > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+                    throw ParserException(std::string(filename) + ": number out of int32 range");
                 }
+                ++p;
             }
+            if (!in_clause) {
+                in_clause = true;
+                tautological = false;
+                seen.clear();
+                clause_start = pos;
+            }
+            terminate = var == 0;
+        } else if (!in_clause) {
+            break;
+        }
+        if (terminate) {
             if (!tautological) {
-                for (int plit : clause) {
-                    std::cout << plit << " ";
+                if (pos + 2 > text.size()) text.resize(2 * text.size());
+                text[pos++] = '0';
+                text[pos++] = '\n';
+                result.clauses++;
+            }
+            in_clause = false;
+            if (p == end) break;
+            continue;
+        }
+        result.vars = std::max(static_cast<int>(var), result.vars);
+        if (tautological) continue;  // skip remainder of clause
+        seen.grow(2 * var + 2);
+        unsigned lit = 2 * var + negative;
+        if (seen[lit ^ 1]) {
+            tautological = true;
+            pos = clause_start;
+        } else if (!seen[lit]) {
+            seen.set(lit);
+            if (pos + 24 > text.size()) text.resize(2 * text.size());
+            if (negative) text[pos++] = '-';
+            pos += format_uint(text.data() + pos, var);
+            text[pos++] = ' ';
+        }
+    }
+    text.resize(pos);
+}
+
+/**
+ * @brief Sanitizes a CNF formula by removing comments and generating a normalized header.
+ * Removes duplicate literals from clauses and removes tautological clauses while preserving
+ * the order of clauses and literals. The header counts the remaining clauses only.
+ * The input is read once in clause-aligned blocks, which are sanitized in parallel by worker threads with thread-local
+ * stamps if several threads are given, and collected in order in a SpillBuffer until the header is known.
+ * 
+ * @param filename
+ * @param output path of output file (compressed by extension), nullptr or "-" for stdout
+ * @param options compression settings
+ * @param n_threads number of worker threads, 1: serial (default), 0: one per core (up to 8)
+ */
+void sanitize(const char* filename, const char* output = nullptr, const CompressionOptions& options = CompressionOptions(), unsigned n_threads = 1) {
+    StreamBuffer in(filename);
+    SpillBuffer body;
+    int vars = 0, clauses = 0;
+    auto append = [&](const SanitizedBlock& result) {
+        body.write(result.text.data(), result.text.size());
+        vars = std::max(result.vars, vars);
+        clauses += result.clauses;
+    };
+
+    const size_t block_size = 1 << 20;
+    std::vector<char> block, rest;
+    if (n_threads == 0) n_threads = num_workers();
+    if (!read_clauses(in, block, rest, block_size)) {
+        // empty formula
+    } else if (n_threads == 1 || (in.eof() && rest.empty())) {
+        Stamp<unsigned> seen;
+        SanitizedBlock result;
+        do {
+            sanitize_block(block, seen, result, filename);
+            append(result);
+        } while (read_clauses(in, block, rest, block_size));
+    } else {
+        WorkQueue<std::pair<size_t, std::vector<char>>> queue(2 * n_threads);
+        OrderedQueue<SanitizedBlock> results(4 * n_threads);
+        std::vector<std::exception_ptr> errors(n_threads + 1);
+        CancellationToken* token = current_cancellation_token();
+        auto fail = [&](unsigned i) {
+            errors[i] = std::current_exception();
+            queue.close();
+            results.close();
+        };
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < n_threads; ++i) {
+            workers.emplace_back([&, i] {
+                CancellationScope scope(token);
+                Stamp<unsigned> seen;
+                std::pair<size_t, std::vector<char>> work;
+                try {
+                    while (queue.pop(work)) {
+                        check_cancellation();
+                        SanitizedBlock result;
+                        sanitize_block(work.second, seen, result, filename);
+                        if (!results.push(work.first, std::move(result))) break;
+                    }
+                } catch (...) {
+                    fail(i);
                 }
-                std::cout << "0" << std::endl;
+            });
+        }
+        std::thread writer([&] {
+            SanitizedBlock result;
+            try {
+                while (results.pop(result)) append(result);
+            } catch (...) {
+                fail(n_threads);
             }
-            clause.clear();
+        });
+        auto join = [&] {
+            queue.close();
+            for (std::thread& worker : workers) worker.join();
+            results.close();
+            writer.join();
+        };
+        try {
+            size_t seq = 0;
+            do {
+                if (!queue.push(std::make_pair(seq++, std::move(block)))) break;
+            } while (read_clauses(in, block, rest, block_size));
+        } catch (...) {
+            results.close();
+            join();
+            throw;
+        }
+        join();
+        for (std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
         }
     }
+
+    StreamWriter out(output, options);
+    write_header(out, vars, clauses);
+    body.copy_to(out);
+    out.close();
 }
 
 
 /**
  * @brief Checks if a CNF formula is already sanitized.
+ * The input is streamed once and the check stops at the first violation.
  * 
  * @param filename 
  * @return true if neither duplicate literals nor tautological clauses are present
@@ -130,25 +323,24 @@ void sanitize(const char* filename) {
 bool check_sanitized(const char* filename) {
     StreamBuffer in(filename);
 
-    int vars, clauses;
-    determine_counts(filename, vars, clauses);
-    
-    // set mask[lit] to clause number if lit is present in clause
-    int* mask = (int*)calloc(2*vars + 2, sizeof(int));
-    mask += vars + 1;
+    // literals of current clause, indexed by 2 * var + sign, grown on demand
+    Stamp<unsigned> seen;
 
-    unsigned stamp = 0;
     while (in.skipWhitespace()) {
         if (*in == 'c' || *in == 'p') {
             if (!in.skipLine()) break;
         } else {
-            ++stamp;
+            seen.clear();
             int plit;
             while (in.readInteger(&plit)) {
                 if (plit == 0) break;
-                if (mask[plit] == stamp || mask[-plit] == stamp) {
+                unsigned var = abs(plit);
+                seen.grow(2 * var + 2);
+                unsigned lit = 2 * var + (plit < 0);
+                if (seen[lit] || seen[lit ^ 1]) {
                     return false;
                 }
+                seen.set(lit);
             }
         }
     }
@@ -0,0 +1,170 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_ARCHIVEREADER_H_
+#define SRC_UTIL_ARCHIVEREADER_H_
+
+#include <archive.h>
+#include <archive_entry.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/util/Cancellation.h"
+#include "src/util/MemoryBudget.h"
+#include "src/util/Profiler.h"
+#include "src/util/StreamBuffer.h"
+
+/**
+ * @brief Walks the regular files of an archive (tar, zip, cpio, etc., compressed or not) in one streaming pass
+ * The content of the current entry is decompressed to memory and registered as MemoryFile,
+ * such that all tools can read it by filename(), also several times, without unpacking the archive to disk.
+ * Only the current entry is held in memory, i.e., memory is bounded by the largest uncompressed entry,
+ * and charged to the memory budget that is current at construction. data() is valid until next() or take_data().
+ * Entries can be compressed themselves, e.g., .cnf.xz files in a .tar.
+ */
+class ArchiveReader {
+    struct archive* archive_;
+    std::string filename_;
+    std::string path_;
+    std::vector<char> data_;
+    MemoryAccount account_;
+    std::unique_ptr<MemoryFile> memory_;
+
+    void read_entry(struct archive_entry* entry) {
+        ScopedTimer timer("decompress");
+        data_.clear();
+        if (archive_entry_size_is_set(entry) && archive_entry_size(entry) > 0) {
+            data_.reserve(archive_entry_size(entry));
+        }
+        const void* block;
+        size_t length;
+        la_int64_t offset;
+        int r;
+        while ((r = archive_read_data_block(archive_, &block, &length, &offset)) == ARCHIVE_OK || r == ARCHIVE_WARN) {
+            check_cancellation();
+            size_t size = std::max(data_.size(), static_cast<size_t>(offset));  // skip holes of sparse entries
+            if (size + length > data_.capacity()) data_.reserve(std::max(2 * data_.capacity(), size + length));
+            account_.set(heap_bytes(data_));
+            data_.resize(size);
+            data_.insert(data_.end(), static_cast<const char*>(block), static_cast<const char*>(block) + length);
+            timer.add_bytes(length);
+        }
+        if (r != ARCHIVE_EOF) {
+            throw ParserException(std::string(archive_error_string(archive_)) + std::string(" Error reading entry: ") + path_);
+        }
+    }
+
+ public:
+    /**
+     * @param filename path of archive, or name of a MemoryFile
+     */
+    explicit ArchiveReader(const char* filename) : archive_(archive_read_new()), filename_(filename), path_(), data_(1), account_(), memory_() {
+        archive_read_support_filter_all(archive_);
+        archive_read_support_format_all(archive_);
+        const char* data = nullptr;
+        size_t size = 0;
+        int r = MemoryFile::find(filename, &data, &size) ? archive_read_open_memory(archive_, data, size) : archive_read_open_filename(archive_, filename, 1 << 16);
+        if (r != ARCHIVE_OK) {
+            std::string error = std::string(archive_error_string(archive_)) + std::string(" Error opening archive: ") + filename_;
+            archive_read_free(archive_);
+            throw ParserException(error);
+        }
+    }
+
+    ~ArchiveReader() {
+        memory_.reset();
+        archive_read_free(archive_);
+    }
+
+    ArchiveReader(const ArchiveReader&) = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+    /**
+     * @brief advance to the next regular file in the archive and read its content
+     * @return false if there are no more entries
+     * @throw ParserException if the archive is corrupt
+     */
+    bool next() {
+        memory_.reset();
+        struct archive_entry* entry;
+        int r;
+        while ((r = archive_read_next_header(archive_, &entry)) == ARCHIVE_OK || r == ARCHIVE_WARN) {
+            if (archive_entry_filetype(entry) != AE_IFREG) continue;
+            path_ = archive_entry_pathname(entry);
+            read_entry(entry);
+            memory_.reset(new MemoryFile(data_.data(), data_.size()));
+            return true;
+        }
+        if (r != ARCHIVE_EOF) {
+            throw ParserException(std::string(archive_error_string(archive_)) + std::string(" Error reading archive: ") + filename_);
+        }
+        return false;
+    }
+
+    /**
+     * @brief path of the current entry inside the archive
+     */
+    const std::string& path() const {
+        return path_;
+    }
+
+    /**
+     * @brief name under which the content of the current entry can be opened, valid until next()
+     */
+    const char* filename() const {
+        return memory_->name();
+    }
+
+    const char* data() const {
+        return data_.data();
+    }
+
+    size_t size() const {
+        return data_.size();
+    }
+
+    /**
+     * @brief move the content of the current entry out, e.g., to hand it over without copy,
+     * filename() and data() of the current entry are invalid afterwards
+     */
+    std::vector<char> take_data() {
+        memory_.reset();
+        std::vector<char> data(1);  // such that data() of the next entry is not null, as in the constructor
+        data.swap(data_);
+        account_.set(0);
+        return data;
+    }
+
+    /**
+     * @brief true if the extension of the given path denotes an archive, e.g., .tar.xz or .zip
+     */
+    static bool is_archive(const std::string& filename) {
+        static const std::vector<std::string> extensions = { ".tar", ".tar.xz", ".tar.lzma", ".tar.gz", ".tar.bz2", ".tar.zst",
+            ".txz", ".tgz", ".tbz2", ".tzst", ".zip", ".7z" };
+        for (const std::string& ext : extensions) {
+            if (filename.size() > ext.size() && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0) return true;
+        }
+        return false;
+    }
+};
+
+#endif  // SRC_UTIL_ARCHIVEREADER_H_
@@ -0,0 +1,359 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_BLOCKDECOMPRESSOR_H_
+#define SRC_UTIL_BLOCKDECOMPRESSOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef GBDC_HAVE_LZMA
+    #include <lzma.h>
+#endif
+#ifdef GBDC_HAVE_ZSTD
+    #include <zstd.h>
+#endif
+
+#include "src/util/Cancellation.h"
+#include "src/util/MemoryBudget.h"
+#include "src/util/WorkQueue.h"
+
+class DecompressionError : public std::runtime_error {
+ public:
+    explicit DecompressionError(const std::string& what) : std::runtime_error(what) { }
+};
+
+/**
+ * @brief number of threads for block decompression, 1: disabled (default), 0: one per core (up to 8)
+ */
+inline std::atomic<unsigned>& decompression_threads() {
+    static std::atomic<unsigned> threads(1);
+    return threads;
+}
+
+/**
+ * @brief Decompresses the independent blocks of multi-block xz files (e.g., from xz -T) and multi-frame zstd files
+ * (e.g., from pzstd) on several threads, and hands out the decompressed data in order.
+ * The input is read in place, files are memory-mapped. Blocks are decoded at most a few blocks ahead of the reader,
+ * the memory for these is charged to the current budget up front.
+ * open() returns nullptr for inputs with a single block, unsupported formats, or if the library was built without
+ * liblzma or libzstd (GBDC_HAVE_LZMA, GBDC_HAVE_ZSTD), the caller then decompresses the input serially.
+ */
+class BlockDecompressor {
+    enum Codec { XZ, ZSTD };
+
+    struct Block {
+        uint64_t offset;  // in input
+        uint64_t size;  // compressed size including headers and padding
+        uint64_t unpadded;  // xz only: size without padding
+        uint64_t length;  // uncompressed size, 0 if unknown (zstd only)
+    };
+
+    Codec codec_;
+    const uint8_t* data_;
+    size_t size_;
+    void* mapping_;  // if the input is a memory-mapped file
+    std::vector<Block> blocks_;
+#ifdef GBDC_HAVE_LZMA
+    lzma_stream_flags flags_;
+#endif
+
+    MemoryAccount account_;
+    std::atomic<size_t> next_;  // next block to decode
+    OrderedQueue<std::vector<char>> results_;
+    std::vector<std::thread> workers_;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_;
+
+    std::vector<char> current_;
+    size_t current_pos_;
+    size_t popped_;
+
+    BlockDecompressor(Codec codec, const uint8_t* data, size_t size, void* mapping, unsigned n_threads)
+     : codec_(codec), data_(data), size_(size), mapping_(mapping), blocks_(), account_(), next_(0), results_(2 * n_threads), workers_(),
+        error_(), failed_(false), current_(), current_pos_(0), popped_(0) { }
+
+#ifdef GBDC_HAVE_LZMA
+    // blocks of a single-stream xz file from its index, false if there is none or the file has more than one stream
+    bool index_xz() {
+        if (size_ < 2 * LZMA_STREAM_HEADER_SIZE) return false;
+        lzma_stream_flags footer;
+        if (lzma_stream_header_decode(&flags_, data_) != LZMA_OK) return false;
+        if (lzma_stream_footer_decode(&footer, data_ + size_ - LZMA_STREAM_HEADER_SIZE) != LZMA_OK) return false;
+        if (lzma_stream_flags_compare(&flags_, &footer) != LZMA_OK) return false;
+        if (footer.backward_size > size_ - 2 * LZMA_STREAM_HEADER_SIZE) return false;
+        lzma_index* index = nullptr;
+        uint64_t memlimit = UINT64_MAX;
+        size_t pos = size_ - LZMA_STREAM_HEADER_SIZE - footer.backward_size;
+        if (lzma_index_buffer_decode(&index, &memlimit, nullptr, data_, &pos, size_ - LZMA_STREAM_HEADER_SIZE) != LZMA_OK) return false;
+        bool single_stream = lzma_index_stream_size(index) == size_;
+        lzma_index_iter iter;
+        lzma_index_iter_init(&iter, index);
+        while (single_stream && !lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+            blocks_.push_back({ iter.block.compressed_file_offset, iter.block.total_size, iter.block.unpadded_size, iter.block.uncompressed_size });
+        }
+        lzma_index_end(index, nullptr);
+        return single_stream;
+    }
+
+    void decode_xz(const Block& b, std::vector<char>& out) const {
+        lzma_filter filters[LZMA_FILTERS_MAX + 1];
+        lzma_block block;
+        std::memset(&block, 0, sizeof(block));
+        block.version = 1;
+        block.check = flags_.check;
+        block.filters = filters;
+        const uint8_t* in = data_ + b.offset;
+        block.header_size = lzma_block_header_size_decode(in[0]);
+        if (block.header_size > b.size || lzma_block_header_decode(&block, nullptr, in) != LZMA_OK) {
+            throw DecompressionError("Error decoding xz block header");
+        }
+        lzma_ret r = lzma_block_compressed_size(&block, b.unpadded);
+        size_t in_pos = block.header_size, out_pos = 0;
+        out.resize(b.length);
+        if (r == LZMA_OK) {
+            r = lzma_block_buffer_decode(&block, nullptr, in, &in_pos, b.size, reinterpret_cast<uint8_t*>(out.data()), &out_pos, out.size());
+        }
+        for (unsigned i = 0; i < LZMA_FILTERS_MAX && filters[i].id != LZMA_VLI_UNKNOWN; ++i) {
+            free(filters[i].options);
+        }
+        if (r != LZMA_OK || out_pos != out.size()) {
+            throw DecompressionError("Error decoding xz block");
+        }
+    }
+#endif
+
+#ifdef GBDC_HAVE_ZSTD
+    // data frames of a zstd file, skippable frames are left out
+    bool index_zstd() {
+        size_t pos = 0;
+        while (pos < size_) {
+            size_t size = ZSTD_findFrameCompressedSize(data_ + pos, size_ - pos);
+            if (ZSTD_isError(size)) return false;
+            unsigned long long length = ZSTD_getFrameContentSize(data_ + pos, size);
+            if (length == ZSTD_CONTENTSIZE_ERROR) return false;
+            const uint8_t* in = data_ + pos;
+            uint32_t magic = in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+            if ((magic & ZSTD_MAGIC_SKIPPABLE_MASK) != ZSTD_MAGIC_SKIPPABLE_START) {
+                blocks_.push_back({ pos, size, size, length == ZSTD_CONTENTSIZE_UNKNOWN ? 0 : length });
+            }
+            pos += size;
+        }
+        return true;
+    }
+
+    void decode_zstd(const Block& b, std::vector<char>& out) const {
+        std::unique_ptr<ZSTD_DCtx, size_t(*)(ZSTD_DCtx*)> ctx(ZSTD_createDCtx(), ZSTD_freeDCtx);
+        if (b.length > 0) {
+            out.resize(b.length);
+            size_t r = ZSTD_decompressDCtx(ctx.get(), out.data(), out.size(), data_ + b.offset, b.size);
+            if (ZSTD_isError(r) || r != out.size()) throw DecompressionError("Error decoding zstd frame");
+            return;
+        }
+        // unknown content size
+        out.clear();
+        ZSTD_inBuffer in = { data_ + b.offset, b.size, 0 };
+        size_t r = 1;
+        while (in.pos < in.size || r != 0) {
+            size_t used = out.size();
+            out.resize(used + ZSTD_DStreamOutSize());
+            ZSTD_outBuffer chunk = { out.data() + used, out.size() - used, 0 };
+            r = ZSTD_decompressStream(ctx.get(), &chunk, &in);
+            if (ZSTD_isError(r) || (chunk.pos == 0 && in.pos == in.size && r != 0)) throw DecompressionError("Error decoding zstd frame");
+            out.resize(used + chunk.pos);
+        }
+    }
+#endif
+
+    void decode(const Block& b, std::vector<char>& out) const {
+    #ifdef GBDC_HAVE_LZMA
+        if (codec_ == XZ) decode_xz(b, out);
+    #endif
+    #ifdef GBDC_HAVE_ZSTD
+        if (codec_ == ZSTD) decode_zstd(b, out);
+    #endif
+    }
+
+    void start(unsigned n_threads) {
+        CancellationToken* token = current_cancellation_token();
+        for (unsigned i = 0; i < n_threads; ++i) {
+            workers_.emplace_back([this, token] {
+                CancellationScope scope(token);
+                try {
+                    for (size_t seq = next_++; seq < blocks_.size(); seq = next_++) {
+                        check_cancellation();
+                        std::vector<char> out;
+                        decode(blocks_[seq], out);
+                        if (!results_.push(seq, std::move(out))) break;
+                    }
+                } catch (...) {
+                    // only the first failing worker publishes its error, closing the queue makes it visible to the reader
+                    if (!failed_.exchange(true)) {
+                        error_ = std::current_exception();
+                        results_.close();
+                    }
+                }
+            });
+        }
+    }
+
+    static void unmap(void* mapping, size_t size) {
+    #ifndef _WIN32
+        if (mapping != nullptr) munmap(mapping, size);
+    #endif
+    }
+
+    // map the given file if it starts with the magic bytes of xz or zstd, nullptr otherwise
+    static const uint8_t* map_file(const char* filename, size_t* size, void** mapping) {
+    #ifdef _WIN32
+        return nullptr;
+    #else
+        static const uint8_t xz_magic[] = { 0xFD, '7', 'z', 'X', 'Z', 0x00 };
+        static const uint8_t zstd_magic[] = { 0x28, 0xB5, 0x2F, 0xFD };
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0) return nullptr;
+        uint8_t magic[6];
+        struct stat st;
+        if (pread(fd, magic, sizeof(magic), 0) != sizeof(magic) || fstat(fd, &st) != 0
+                || (std::memcmp(magic, xz_magic, sizeof(xz_magic)) != 0 && std::memcmp(magic, zstd_magic, sizeof(zstd_magic)) != 0)) {
+            ::close(fd);
+            return nullptr;
+        }
+        *size = st.st_size;
+        *mapping = mmap(nullptr, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (*mapping == MAP_FAILED) {
+            *mapping = nullptr;
+            return nullptr;
+        }
+        return static_cast<const uint8_t*>(*mapping);
+    #endif
+    }
+
+ public:
+    /**
+     * @brief block decompressor for the given file or memory region
+     * @param filename path of file, read if data is nullptr
+     * @return nullptr if the input can not be decompressed in parallel
+     */
+    static std::unique_ptr<BlockDecompressor> open(const char* filename, const char* data = nullptr, size_t size = 0) {
+        unsigned n_threads = decompression_threads();
+        if (n_threads == 0) n_threads = num_workers();
+        if (n_threads < 2) return nullptr;
+    #if defined(GBDC_HAVE_LZMA) || defined(GBDC_HAVE_ZSTD)
+        void* mapping = nullptr;
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+        if (in == nullptr) in = map_file(filename, &size, &mapping);
+        if (in == nullptr || size < 6) {
+            unmap(mapping, size);
+            return nullptr;
+        }
+        std::unique_ptr<BlockDecompressor> decompressor;
+        bool indexed = false;
+    #ifdef GBDC_HAVE_LZMA
+        if (in[0] == 0xFD) {
+            decompressor.reset(new BlockDecompressor(XZ, in, size, mapping, n_threads));
+            indexed = decompressor->index_xz();
+        }
+    #endif
+    #ifdef GBDC_HAVE_ZSTD
+        if (in[0] == 0x28) {
+            decompressor.reset(new BlockDecompressor(ZSTD, in, size, mapping, n_threads));
+            indexed = decompressor->index_zstd();
+        }
+    #endif
+        if (decompressor == nullptr) {
+            unmap(mapping, size);
+            return nullptr;
+        }
+        if (!indexed || decompressor->blocks_.size() < 2) return nullptr;
+        n_threads = std::min<size_t>(n_threads, decompressor->blocks_.size());
+        // blocks in the ordered queue, in the workers, and the current one of the reader
+        uint64_t block = 0;
+        for (const Block& b : decompressor->blocks_) block = std::max(block, b.length > 0 ? b.length : 4 * b.size);
+        try {
+            decompressor->account_.charge((3 * n_threads + 1) * block);
+        } catch (MemoryLimitExceeded& e) {
+            return nullptr;
+        }
+        decompressor->start(n_threads);
+        return decompressor;
+    #else
+        return nullptr;
+    #endif
+    }
+
+    ~BlockDecompressor() {
+        results_.close();
+        for (std::thread& worker : workers_) worker.join();
+        unmap(mapping_, size_);
+    }
+
+    BlockDecompressor(const BlockDecompressor&) = delete;
+    BlockDecompressor& operator=(const BlockDecompressor&) = delete;
+
+    /**
+     * @brief copy up to length decompressed bytes to buffer
+     * @return number of copied bytes, 0 at the end of input
+     * @throw DecompressionError if a block is corrupt, TimeLimitExceeded if cancelled
+     */
+    size_t read(char* buffer, size_t length) {
+        size_t copied = 0;
+        while (copied < length) {
+            if (current_pos_ == current_.size()) {
+                if (popped_ == blocks_.size()) break;
+                if (!results_.pop(current_)) {
+                    if (error_) std::rethrow_exception(error_);
+                    throw DecompressionError("Error decoding block");
+                }
+                ++popped_;
+                current_pos_ = 0;
+                continue;
+            }
+            size_t n = std::min(length - copied, current_.size() - current_pos_);
+            std::memcpy(buffer + copied, current_.data() + current_pos_, n);
+            current_pos_ += n;
+            copied += n;
+        }
+        return copied;
+    }
+
+    size_t blocks() const {
+        return blocks_.size();
+    }
+};
+
+#endif  // SRC_UTIL_BLOCKDECOMPRESSOR_H_
@@ -27,14 +27,16 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include "src/util/StreamBuffer.h"
 #include "src/util/SolverTypes.h"
+#include "src/util/MemoryBudget.h"
 #include "src/util/ResourceLimits.h"
 
 class CNFFormula {
     For formula;
     unsigned variables;
+    MemoryAccount memory;
 
  public:
-    CNFFormula() : formula(), variables(0) { }
+    CNFFormula() : formula(), variables(0), memory() { }
 
     explicit CNFFormula(const char* filename) : CNFFormula() {
         readDimacsFromFile(filename);
@@ -141,6 +143,12 @@ class CNFFormula {
             clause->shrink_to_fit();
             variables = std::max(variables, (unsigned int)clause->back().var());
         }
+        try {
+            memory.charge(sizeof(Cl*) + sizeof(Cl) + heap_bytes(*clause));
+        } catch (MemoryLimitExceeded& e) {
+            delete clause;
+            throw;
+        }
         formula.push_back(clause);
     }
 };
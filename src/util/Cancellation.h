@@ -0,0 +1,222 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_CANCELLATION_H_
+#define SRC_UTIL_CANCELLATION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+    #include <pthread.h>
+    #include <time.h>
+#endif
+
+#include "src/util/Profiler.h"
+
+struct TimeLimitExceeded : public std::exception {
+    const char* what() const throw() {
+        return "Exceeded Time Limit";
+    }
+};
+
+/**
+ * @brief Which cpu time counts towards the cpu deadline of a token
+ */
+enum class CpuTime {
+    PROCESS,  // all threads of the process, e.g., one task per process as in the command line tool or a python worker
+    SCOPES,  // threads while they have a CancellationScope of the token, e.g., concurrent tasks of the server
+};
+
+/**
+ * Cooperative cancellation: a token carries optional wall-clock and cpu deadlines with millisecond resolution,
+ * and can be cancelled explicitly from any thread. Parsing and gate analysis poll the token of the current thread
+ * at cheap intervals and throw TimeLimitExceeded once it expired. Deadlines thus apply per task,
+ * also when several tasks run in threads of one process, and the cpu time of worker threads of a task counts towards its deadline.
+ */
+class CancellationToken {
+    friend class CancellationScope;
+
+    struct Thread {  // thread with a scope of this token
+        const void* scope;
+    #ifndef _WIN32
+        clockid_t clock;
+    #endif
+        uint64_t start;  // cpu time of the thread when the scope was installed
+    };
+
+    std::atomic<bool> cancelled_;
+    uint64_t wall_deadline_;  // nanoseconds, 0: none
+    uint64_t cpu_deadline_;  // nanoseconds, 0: none
+    CpuTime cpu_time_;
+
+    mutable std::mutex mutex_;
+    std::vector<Thread> threads_;  // CpuTime::SCOPES: threads which currently have a scope
+    uint64_t finished_ns_;  // CpuTime::SCOPES: cpu time of scopes which ended
+
+#ifndef _WIN32
+    static uint64_t clock_ns(clockid_t clock) {
+        struct timespec ts;
+        if (clock_gettime(clock, &ts) != 0) return 0;
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+
+    // cpu time counted towards the deadline, readable from any thread
+    uint64_t cpu_ns() const {
+    #ifdef _WIN32
+        return 0;
+    #else
+        if (cpu_time_ == CpuTime::PROCESS) return clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t total = finished_ns_;
+        for (const Thread& thread : threads_) total += clock_ns(thread.clock) - thread.start;
+        return total;
+    #endif
+    }
+
+    // count the cpu time of the calling thread from now on, for CpuTime::SCOPES
+    void attach(const void* scope) {
+        if (cpu_time_ != CpuTime::SCOPES) return;
+    #ifndef _WIN32
+        Thread thread;
+        thread.scope = scope;
+        if (pthread_getcpuclockid(pthread_self(), &thread.clock) != 0) thread.clock = CLOCK_THREAD_CPUTIME_ID;
+        thread.start = clock_ns(thread.clock);
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(thread);
+    #endif
+    }
+
+    void detach(const void* scope) {
+        if (cpu_time_ != CpuTime::SCOPES) return;
+    #ifndef _WIN32
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < threads_.size(); ++i) {
+            if (threads_[i].scope == scope) {
+                finished_ns_ += clock_ns(threads_[i].clock) - threads_[i].start;
+                threads_[i] = threads_.back();
+                threads_.pop_back();
+                return;
+            }
+        }
+    #endif
+    }
+
+ public:
+    /**
+     * @param wall_ms wall-clock time limit in milliseconds from now, 0: none
+     * @param cpu_ms cpu time limit in milliseconds from now, 0: none
+     * @param cpu_time which cpu time counts towards the cpu time limit
+     */
+    explicit CancellationToken(uint64_t wall_ms = 0, uint64_t cpu_ms = 0, CpuTime cpu_time = CpuTime::PROCESS)
+     : cancelled_(false), wall_deadline_(0), cpu_deadline_(0), cpu_time_(cpu_time), mutex_(), threads_(), finished_ns_(0) {
+        if (wall_ms > 0) wall_deadline_ = profile_wall_ns() + wall_ms * 1000000ULL;
+        if (cpu_ms > 0) cpu_deadline_ = cpu_ns() + cpu_ms * 1000000ULL;
+    }
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void cancel() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief true if cancelled or a deadline passed, reads the clocks
+     */
+    bool expired() {
+        if (cancelled_.load(std::memory_order_relaxed)) return true;
+        if ((wall_deadline_ > 0 && profile_wall_ns() >= wall_deadline_) || (cpu_deadline_ > 0 && cpu_ns() >= cpu_deadline_)) {
+            cancel();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @throw TimeLimitExceeded if expired
+     */
+    void check() {
+        if (expired()) throw TimeLimitExceeded();
+    }
+};
+
+/**
+ * @brief token polled by the current thread, nullptr if there is none
+ */
+inline CancellationToken*& current_cancellation_token() {
+    thread_local CancellationToken* token = nullptr;
+    return token;
+}
+
+/**
+ * @brief Makes the given token the current token of the calling thread for its lifetime, e.g., in worker threads of a task
+ * With CpuTime::SCOPES, the cpu time of the calling thread counts towards the deadline of the token for this lifetime.
+ */
+class CancellationScope {
+    CancellationToken* previous_;
+    CancellationToken* token_;  // token whose cpu time this scope counts, nullptr if none
+
+ public:
+    explicit CancellationScope(CancellationToken* token) : previous_(current_cancellation_token()), token_(nullptr) {
+        current_cancellation_token() = token;
+        if (token != nullptr && token != previous_) {  // nested scopes of one token count once
+            token_ = token;
+            token_->attach(this);
+        }
+    }
+
+    ~CancellationScope() {
+        if (token_ != nullptr) token_->detach(this);
+        current_cancellation_token() = previous_;
+    }
+
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+};
+
+/**
+ * @brief poll the current token, for places that run about once per millisecond or less, e.g., per buffer
+ * @throw TimeLimitExceeded if expired
+ */
+inline void check_cancellation() {
+    CancellationToken* token = current_cancellation_token();
+    if (token != nullptr) token->check();
+}
+
+/**
+ * @brief poll the current token once a budget of work is used up, for hot loops
+ * @param weight work done since the last call, e.g., number of visited clauses
+ * @throw TimeLimitExceeded if expired
+ */
+inline void cancellation_point(uint64_t weight = 1) {
+    thread_local uint64_t budget = 0;
+    if (budget > weight) {
+        budget -= weight;
+    } else {
+        budget = 1 << 14;
+        check_cancellation();
+    }
+}
+
+#endif  // SRC_UTIL_CANCELLATION_H_
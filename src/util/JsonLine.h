@@ -0,0 +1,296 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_JSONLINE_H_
+#define SRC_UTIL_JSONLINE_H_
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct JsonError : public std::runtime_error {
+    explicit JsonError(const std::string& msg) : std::runtime_error(msg) { }
+};
+
+/**
+ * @brief One JSON object, e.g., a request in newline-delimited JSON
+ * Only the members of the top-level object are accessible, their values are kept as raw JSON text,
+ * such that nested values can be passed on unchanged, e.g., request ids.
+ */
+class JsonObject {
+    std::map<std::string, std::string> values_;
+
+    static void skip_space(const std::string& text, size_t& pos) {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) ++pos;
+    }
+
+    static void expect(const std::string& text, size_t& pos, char c) {
+        skip_space(text, pos);
+        if (pos >= text.size() || text[pos] != c) {
+            throw JsonError(std::string("expected '") + c + "' at position " + std::to_string(pos));
+        }
+        ++pos;
+    }
+
+    static unsigned hex4(const std::string& text, size_t pos) {
+        if (pos + 4 > text.size()) throw JsonError("truncated unicode escape");
+        unsigned code = 0;
+        for (size_t i = pos; i < pos + 4; ++i) {
+            char c = text[i];
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else throw JsonError("invalid unicode escape");
+        }
+        return code;
+    }
+
+    static void append_utf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    // parse string starting at the opening quote, decode escapes
+    static std::string parse_string(const std::string& text, size_t& pos) {
+        expect(text, pos, '"');
+        std::string out;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (static_cast<unsigned char>(c) < 0x20) throw JsonError("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            c = text[pos++];
+            switch (c) {
+                case '"': case '\\': case '/': out += c; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned code = hex4(text, pos);
+                    pos += 4;
+                    if (code >= 0xD800 && code < 0xDC00 && text.compare(pos, 2, "\\u") == 0) {
+                        unsigned low = hex4(text, pos + 2);
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            pos += 6;
+                        }
+                    }
+                    append_utf8(out, code);
+                    break;
+                }
+                default: throw JsonError(std::string("invalid escape '\\") + c + "'");
+            }
+        }
+        if (pos >= text.size()) throw JsonError("unterminated string");
+        ++pos;
+        return out;
+    }
+
+    // skip any value, nested ones included
+    static void skip_value(const std::string& text, size_t& pos, unsigned depth = 0) {
+        if (depth > 64) throw JsonError("nesting too deep");
+        skip_space(text, pos);
+        if (pos >= text.size()) throw JsonError("missing value");
+        char c = text[pos];
+        if (c == '"') {
+            parse_string(text, pos);
+        } else if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            ++pos;
+            skip_space(text, pos);
+            if (pos < text.size() && text[pos] == close) {
+                ++pos;
+                return;
+            }
+            for (;;) {
+                if (c == '{') {
+                    parse_string(text, pos);
+                    expect(text, pos, ':');
+                }
+                skip_value(text, pos, depth + 1);
+                skip_space(text, pos);
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                    skip_space(text, pos);
+                    continue;
+                }
+                expect(text, pos, close);
+                return;
+            }
+        } else {
+            // number, true, false, null
+            size_t begin = pos;
+            while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '-' || text[pos] == '+' || text[pos] == '.')) ++pos;
+            std::string token = text.substr(begin, pos - begin);
+            if (token == "true" || token == "false" || token == "null") return;
+            char* end = nullptr;
+            std::strtod(token.c_str(), &end);
+            if (token.empty() || !(token[0] == '-' || std::isdigit(static_cast<unsigned char>(token[0]))) || *end != '\0'
+                    || token.find_first_not_of("0123456789+-.eE") != std::string::npos) {
+                throw JsonError("invalid value at position " + std::to_string(begin));
+            }
+        }
+    }
+
+ public:
+    /**
+     * @throw JsonError if text is not one JSON object
+     */
+    explicit JsonObject(const std::string& text) : values_() {
+        size_t pos = 0;
+        expect(text, pos, '{');
+        skip_space(text, pos);
+        if (pos < text.size() && text[pos] == '}') {
+            ++pos;
+        } else {
+            for (;;) {
+                skip_space(text, pos);
+                std::string key = parse_string(text, pos);
+                expect(text, pos, ':');
+                skip_space(text, pos);
+                size_t begin = pos;
+                skip_value(text, pos);
+                values_[key] = text.substr(begin, pos - begin);
+                skip_space(text, pos);
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                    continue;
+                }
+                expect(text, pos, '}');
+                break;
+            }
+        }
+        skip_space(text, pos);
+        if (pos != text.size()) throw JsonError("trailing characters after object");
+    }
+
+    bool has(const std::string& key) const {
+        return values_.count(key) > 0;
+    }
+
+    /**
+     * @brief raw JSON text of the value of key
+     */
+    const std::string& raw(const std::string& key) const {
+        auto it = values_.find(key);
+        if (it == values_.end()) throw JsonError("missing member \"" + key + "\"");
+        return it->second;
+    }
+
+    /**
+     * @brief value of key, which must be a string, or fallback if key is missing or null
+     */
+    std::string get_string(const std::string& key, const std::string& fallback = "") const {
+        auto it = values_.find(key);
+        if (it == values_.end() || it->second == "null") return fallback;
+        if (it->second.empty() || it->second[0] != '"') throw JsonError("member \"" + key + "\" must be a string");
+        size_t pos = 0;
+        return parse_string(it->second, pos);
+    }
+
+    /**
+     * @brief value of key, which must be a non-negative integer of at most max, or fallback if key is missing or null
+     */
+    uint64_t get_uint(const std::string& key, uint64_t fallback = 0, uint64_t max = UINT64_MAX) const {
+        auto it = values_.find(key);
+        if (it == values_.end() || it->second == "null") return fallback;
+        const std::string& value = it->second;
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 19) {
+            throw JsonError("member \"" + key + "\" must be a non-negative integer");
+        }
+        uint64_t number = std::stoull(value);
+        if (number > max) throw JsonError("member \"" + key + "\" must be at most " + std::to_string(max));
+        return number;
+    }
+};
+
+/**
+ * @brief text as quoted JSON string
+ */
+inline std::string json_string(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+/**
+ * @brief value as JSON number, null if not finite
+ */
+inline std::string json_number(double value) {
+    if (!std::isfinite(value)) return "null";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15g", value);
+    if (std::strtod(buf, nullptr) != value) std::snprintf(buf, sizeof(buf), "%.17g", value);  // round trip
+    return buf;
+}
+
+/**
+ * @brief JSON object of the given names and values, e.g., a feature record
+ */
+inline std::string json_record(const std::vector<std::string>& names, const std::vector<double>& record) {
+    std::string out = "{";
+    for (unsigned i = 0; i < record.size() && i < names.size(); ++i) {
+        if (i > 0) out += ", ";
+        out += json_string(names[i]) + ": " + json_number(record[i]);
+    }
+    return out + "}";
+}
+
+#endif  // SRC_UTIL_JSONLINE_H_
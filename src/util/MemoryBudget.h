@@ -0,0 +1,190 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_MEMORYBUDGET_H_
+#define SRC_UTIL_MEMORYBUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+struct MemoryLimitExceeded : public std::exception {
+    const char* what() const throw() {
+        return "Exceeded Memory Limit";
+    }
+};
+
+/**
+ * Per-task memory accounting: the large data structures (formula, occurrence lists, gate formula, etc.) charge
+ * their heap memory to the budget of the task that created them, and release it when they are destroyed.
+ * A charge beyond the limit throws MemoryLimitExceeded in that task only, so concurrent extractions
+ * with individual budgets can share one process.
+ */
+class MemoryBudget {
+    uint64_t limit_;  // bytes, 0: unlimited
+    std::atomic<uint64_t> used_;
+    std::atomic<uint64_t> peak_;
+
+ public:
+    explicit MemoryBudget(uint64_t limit = 0) : limit_(limit), used_(0), peak_(0) { }
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * @throw MemoryLimitExceeded if the limit would be exceeded, then nothing is charged
+     */
+    void charge(uint64_t bytes) {
+        uint64_t used = used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (limit_ > 0 && used > limit_) {
+            used_.fetch_sub(bytes, std::memory_order_relaxed);
+            throw MemoryLimitExceeded();
+        }
+        uint64_t peak = peak_.load(std::memory_order_relaxed);
+        while (used > peak && !peak_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) { }
+    }
+
+    void release(uint64_t bytes) {
+        used_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    uint64_t limit() const {
+        return limit_;
+    }
+
+    uint64_t used() const {
+        return used_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t peak() const {
+        return peak_.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief budget charged by data structures created in the current thread, nullptr if there is none
+ */
+inline MemoryBudget*& current_memory_budget() {
+    thread_local MemoryBudget* budget = nullptr;
+    return budget;
+}
+
+/**
+ * @brief Makes the given budget the current budget of the calling thread for its lifetime
+ */
+class MemoryBudgetScope {
+    MemoryBudget* previous_;
+
+ public:
+    explicit MemoryBudgetScope(MemoryBudget* budget) : previous_(current_memory_budget()) {
+        current_memory_budget() = budget;
+    }
+
+    ~MemoryBudgetScope() {
+        current_memory_budget() = previous_;
+    }
+
+    MemoryBudgetScope(const MemoryBudgetScope&) = delete;
+    MemoryBudgetScope& operator=(const MemoryBudgetScope&) = delete;
+};
+
+/**
+ * @brief Memory charged by one data structure to the budget that was current at its construction
+ * Copies charge the same amount again, moves take over the charge, destruction releases everything.
+ */
+class MemoryAccount {
+    MemoryBudget* budget_;
+    uint64_t bytes_;
+
+ public:
+    MemoryAccount() : budget_(current_memory_budget()), bytes_(0) { }
+
+    /**
+     * @brief account of the given budget, e.g., for data created by a thread on behalf of another
+     */
+    explicit MemoryAccount(MemoryBudget* budget) : budget_(budget), bytes_(0) { }
+
+    MemoryAccount(const MemoryAccount& other) : budget_(other.budget_), bytes_(0) {
+        charge(other.bytes_);
+    }
+
+    MemoryAccount& operator=(const MemoryAccount& other) {
+        if (this != &other) {
+            set(0);
+            budget_ = other.budget_;
+            charge(other.bytes_);
+        }
+        return *this;
+    }
+
+    MemoryAccount(MemoryAccount&& other) : budget_(other.budget_), bytes_(other.bytes_) {
+        other.bytes_ = 0;
+    }
+
+    MemoryAccount& operator=(MemoryAccount&& other) {
+        if (this != &other) {
+            set(0);
+            budget_ = other.budget_;
+            bytes_ = other.bytes_;
+            other.bytes_ = 0;
+        }
+        return *this;
+    }
+
+    ~MemoryAccount() {
+        set(0);
+    }
+
+    /**
+     * @throw MemoryLimitExceeded if the budget is exhausted
+     */
+    void charge(uint64_t bytes) {
+        if (budget_ != nullptr) budget_->charge(bytes);
+        bytes_ += bytes;
+    }
+
+    void release(uint64_t bytes) {
+        if (bytes > bytes_) bytes = bytes_;
+        if (budget_ != nullptr) budget_->release(bytes);
+        bytes_ -= bytes;
+    }
+
+    /**
+     * @brief charge or release the difference to the given total
+     */
+    void set(uint64_t bytes) {
+        if (bytes > bytes_) {
+            charge(bytes - bytes_);
+        } else {
+            release(bytes_ - bytes);
+        }
+    }
+
+    uint64_t bytes() const {
+        return bytes_;
+    }
+};
+
+template <typename T>
+inline uint64_t heap_bytes(const std::vector<T>& vector) {
+    return vector.capacity() * sizeof(T);
+}
+
+#endif  // SRC_UTIL_MEMORYBUDGET_H_
@@ -0,0 +1,90 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_NUMBERFORMAT_H_
+#define SRC_UTIL_NUMBERFORMAT_H_
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Integer to decimal text conversion without the overhead of printf or iostreams.
+ * The output buffer must have room for at least 20 (unsigned) or 21 (signed) characters.
+ * No terminating '\0' is written.
+ */
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+inline unsigned count_digits(uint64_t value) {
+    unsigned n = 1;
+    for (;;) {
+        if (value < 10) return n;
+        if (value < 100) return n + 1;
+        if (value < 1000) return n + 2;
+        if (value < 10000) return n + 3;
+        value /= 10000;
+        n += 4;
+    }
+}
+
+/**
+ * @brief write decimal representation of value to out
+ * @return number of characters written
+ */
+inline unsigned format_uint(char* out, uint64_t value) {
+    const unsigned length = count_digits(value);
+    char* pos = out + length;
+    while (value >= 100) {
+        const unsigned i = (value % 100) * 2;
+        value /= 100;
+        *--pos = digit_pairs[i + 1];
+        *--pos = digit_pairs[i];
+    }
+    if (value < 10) {
+        *--pos = '0' + value;
+    } else {
+        *--pos = digit_pairs[value * 2 + 1];
+        *--pos = digit_pairs[value * 2];
+    }
+    return length;
+}
+
+/**
+ * @brief write decimal representation of value to out, with leading '-' for negative values
+ * @return number of characters written
+ */
+inline unsigned format_int(char* out, int64_t value) {
+    if (value < 0) {
+        *out = '-';
+        return 1 + format_uint(out + 1, ~static_cast<uint64_t>(value) + 1);
+    }
+    return format_uint(out, value);
+}
+
+#endif  // SRC_UTIL_NUMBERFORMAT_H_
@@ -0,0 +1,305 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_PREFETCHREADER_H_
+#define SRC_UTIL_PREFETCHREADER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef GBDC_HAVE_LIBURING
+    #include <liburing.h>
+#endif
+
+#include "src/util/MemoryBudget.h"
+#include "src/util/WorkQueue.h"
+
+/**
+ * @brief Reads the (compressed) bytes of a list of files ahead of their use, such that I/O latency
+ * is hidden behind parsing of the current file, e.g., in batch mode over many small files on network storage.
+ * Up to depth files are in flight. With io_uring (GBDC_HAVE_LIBURING) the reads are queued in the kernel,
+ * otherwise, or if io_uring is not available at runtime, a pool of reader threads does blocking reads.
+ * Files are handed out in the given order, as memory buffers for StreamBuffer.
+ * Files larger than max_size or which can not be read are not loaded, the consumer opens them by name as usual,
+ * which also reports errors as usual.
+ * Loaded files are charged to the memory budget which is current at construction of the reader, until the consumer
+ * releases them. A file which would exceed the budget is not loaded.
+ */
+class PrefetchReader {
+ public:
+    struct File {
+        size_t index;  // in the list of files
+        bool loaded;  // false: read file by name
+        std::vector<char> data;
+        MemoryAccount memory;  // charges data
+    };
+
+ private:
+    const std::vector<std::string>& filenames_;
+    unsigned depth_;
+    size_t max_size_;
+    MemoryBudget* budget_;
+    size_t next_;  // next file to hand out
+
+    // thread pool
+    std::atomic<size_t> next_read_;
+    OrderedQueue<File> files_;
+    std::vector<std::thread> readers_;
+
+    // charge the size of the file to the budget before its data is allocated
+    static bool allocate(File& file, size_t size, MemoryBudget* budget) {
+        file.memory = MemoryAccount(budget);
+        try {
+            file.memory.charge(size);
+        } catch (const MemoryLimitExceeded&) {
+            return false;
+        }
+        file.data.resize(size);
+        return true;
+    }
+
+    static void unload(File& file) {
+        file.loaded = false;
+        std::vector<char>().swap(file.data);
+        file.memory.set(0);
+    }
+
+    static void read_file(const std::string& filename, size_t max_size, MemoryBudget* budget, File& file) {
+        file.loaded = false;
+    #ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && static_cast<size_t>(st.st_size) <= max_size && allocate(file, st.st_size, budget)) {
+            size_t done = 0;
+            while (done < file.data.size()) {
+                ssize_t length = pread(fd, file.data.data() + done, file.data.size() - done, done);
+                if (length <= 0) break;
+                done += length;
+            }
+            file.loaded = done == file.data.size();
+        }
+        ::close(fd);
+    #endif
+        if (!file.loaded) unload(file);
+    }
+
+    void start_readers() {
+        unsigned n_readers = std::min<size_t>(depth_, filenames_.size());
+        for (unsigned i = 0; i < n_readers; ++i) {
+            readers_.emplace_back([this] {
+                for (size_t index = next_read_++; index < filenames_.size(); index = next_read_++) {
+                    File file;
+                    file.index = index;
+                    read_file(filenames_[index], max_size_, budget_, file);
+                    if (!files_.push(index, std::move(file))) break;
+                }
+            });
+        }
+    }
+
+#ifdef GBDC_HAVE_LIBURING
+    enum Op : uintptr_t { OPEN = 1, STAT = 2, READ = 3 };
+
+    struct Request {
+        File file;
+        int fd;
+        int pending;  // submitted operations
+        bool failed;
+        size_t done;  // bytes read
+        struct statx stx;
+    };
+
+    struct io_uring ring_;
+    bool uring_;
+    size_t next_submit_;
+    std::map<size_t, std::unique_ptr<Request>> requests_;  // in flight or ready, by index
+
+    static void* tag(Request* request, Op op) {
+        return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(request) | op);
+    }
+
+    // queue open and statx of the next files, up to depth in flight
+    void submit() {
+        while (next_submit_ < filenames_.size() && next_submit_ < next_ + depth_) {
+            io_uring_sqe* open = io_uring_get_sqe(&ring_);
+            io_uring_sqe* stat = open != nullptr ? io_uring_get_sqe(&ring_) : nullptr;
+            if (stat == nullptr) {
+                if (open != nullptr) {
+                    io_uring_prep_nop(open);
+                    io_uring_sqe_set_data(open, nullptr);
+                }
+                break;
+            }
+            std::unique_ptr<Request> request(new Request());
+            request->file.index = next_submit_;
+            request->file.loaded = false;
+            request->fd = -1;
+            request->pending = 2;
+            request->failed = false;
+            request->done = 0;
+            const char* path = filenames_[next_submit_].c_str();
+            io_uring_prep_openat(open, AT_FDCWD, path, O_RDONLY, 0);
+            io_uring_sqe_set_data(open, tag(request.get(), OPEN));
+            io_uring_prep_statx(stat, AT_FDCWD, path, 0, STATX_TYPE | STATX_SIZE, &request->stx);
+            io_uring_sqe_set_data(stat, tag(request.get(), STAT));
+            requests_.emplace(next_submit_++, std::move(request));
+        }
+        io_uring_submit(&ring_);
+    }
+
+    // open and statx complete in any order, then the file is read in one or more reads
+    void complete(io_uring_cqe* cqe) {
+        uintptr_t data = reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe));
+        if (data == 0) return;  // nop
+        Request* request = reinterpret_cast<Request*>(data & ~uintptr_t(3));
+        Op op = static_cast<Op>(data & 3);
+        int res = cqe->res;
+        --request->pending;
+        if (op == OPEN) {
+            if (res < 0) request->failed = true;
+            else request->fd = res;
+        } else if (op == STAT) {
+            if (res < 0 || !S_ISREG(request->stx.stx_mode) || request->stx.stx_size > max_size_) request->failed = true;
+            else if (!allocate(request->file, request->stx.stx_size, budget_)) request->failed = true;
+        } else if (res <= 0) {  // READ, the file shrank if 0
+            request->failed = true;
+        } else {
+            request->done += res;
+        }
+        if (request->pending > 0) return;
+        if (!request->failed && request->done < request->file.data.size()) {
+            io_uring_sqe* read = io_uring_get_sqe(&ring_);
+            if (read != nullptr) {
+                io_uring_prep_read(read, request->fd, request->file.data.data() + request->done, request->file.data.size() - request->done, request->done);
+                io_uring_sqe_set_data(read, tag(request, READ));
+                ++request->pending;
+                return;
+            }
+            request->failed = true;
+        }
+        if (request->fd >= 0) ::close(request->fd);
+        request->fd = -1;
+        request->file.loaded = !request->failed;
+        if (request->failed) unload(request->file);
+    }
+
+    bool ready(size_t index) const {
+        auto it = requests_.find(index);
+        return it != requests_.end() && it->second->pending == 0 && it->second->fd < 0;
+    }
+
+    // wait for at least one completion and process all available ones
+    bool wait() {
+        io_uring_cqe* cqe;
+        int r;
+        do {
+            r = io_uring_submit_and_wait(&ring_, 1);
+        } while (r == -EINTR);
+        if (r < 0 || io_uring_peek_cqe(&ring_, &cqe) != 0) return false;
+        do {
+            complete(cqe);
+            io_uring_cqe_seen(&ring_, cqe);
+        } while (io_uring_peek_cqe(&ring_, &cqe) == 0);
+        return true;
+    }
+#endif
+
+ public:
+    /**
+     * @param filenames files to read in this order, must outlive the reader
+     * @param depth maximum number of files in flight or waiting to be handed out
+     * @param max_size files larger than this are not loaded
+     * Files read ahead are charged to the current memory budget, handed out files until the consumer releases them.
+     */
+    explicit PrefetchReader(const std::vector<std::string>& filenames, unsigned depth = 16, size_t max_size = 1 << 26)
+     : filenames_(filenames), depth_(std::max(1u, depth)), max_size_(max_size), budget_(current_memory_budget()), next_(0), next_read_(0), files_(depth_), readers_() {
+    #ifdef GBDC_HAVE_LIBURING
+        next_submit_ = 0;
+        uring_ = io_uring_queue_init(4 * depth_, &ring_, 0) == 0;
+        if (uring_) return;
+    #endif
+        start_readers();
+    }
+
+    ~PrefetchReader() {
+        files_.close();
+        for (std::thread& reader : readers_) reader.join();
+    #ifdef GBDC_HAVE_LIBURING
+        if (uring_) {
+            // wait for all operations which still refer to requests
+            for (auto& request : requests_) {
+                while (request.second->pending > 0 && wait()) { }
+                if (request.second->fd >= 0) ::close(request.second->fd);
+            }
+            io_uring_queue_exit(&ring_);
+        }
+    #endif
+    }
+
+    PrefetchReader(const PrefetchReader&) = delete;
+    PrefetchReader& operator=(const PrefetchReader&) = delete;
+
+    /**
+     * @brief next file in the given order, waits until it is read
+     * @return false if all files were handed out
+     */
+    bool next(File& file) {
+        if (next_ >= filenames_.size()) return false;
+    #ifdef GBDC_HAVE_LIBURING
+        if (uring_) {
+            submit();
+            while (!ready(next_)) {
+                if (!wait()) {
+                    // give up on prefetching this file, it is opened by name, its request is released at destruction
+                    file.index = next_++;
+                    unload(file);
+                    return true;
+                }
+            }
+            auto it = requests_.find(next_);
+            file = std::move(it->second->file);
+            requests_.erase(it);
+            ++next_;
+            submit();
+            return true;
+        }
+    #endif
+        if (!files_.pop(file)) return false;
+        ++next_;
+        return true;
+    }
+};
+
+#endif  // SRC_UTIL_PREFETCHREADER_H_
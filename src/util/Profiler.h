@@ -0,0 +1,223 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_PROFILER_H_
+#define SRC_UTIL_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+    #include <time.h>
+#endif
+
+/**
+ * Per-stage profiling: wall time, cpu time (both in nanoseconds), bytes processed and number of calls.
+ * Profiling is disabled by default, then timers cost no more than one check of a flag.
+ * Stages nest, e.g., decompression is part of tokenizing, so times of nested stages are included in their parents.
+ */
+
+inline uint64_t profile_wall_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief cpu time of the calling thread
+ */
+inline uint64_t profile_cpu_ns() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+struct StageProfile {
+    uint64_t calls = 0;
+    uint64_t wall_ns = 0;
+    uint64_t cpu_ns = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * @brief Process-wide registry of stage profiles, in order of first appearance
+ */
+class Profiler {
+    std::atomic<bool> enabled_;
+    mutable std::mutex mutex;
+    std::vector<std::pair<std::string, StageProfile>> stages_;
+
+    Profiler() : enabled_(false), stages_() { }
+
+ public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    static bool enabled() {
+        return instance().enabled_.load(std::memory_order_relaxed);
+    }
+
+    void enable(bool enabled = true) {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stages_.clear();
+    }
+
+    void record(const char* stage, uint64_t wall_ns, uint64_t cpu_ns, uint64_t bytes = 0, uint64_t calls = 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : stages_) {
+            if (entry.first == stage) {
+                entry.second.calls += calls;
+                entry.second.wall_ns += wall_ns;
+                entry.second.cpu_ns += cpu_ns;
+                entry.second.bytes += bytes;
+                return;
+            }
+        }
+        StageProfile profile;
+        profile.calls = calls;
+        profile.wall_ns = wall_ns;
+        profile.cpu_ns = cpu_ns;
+        profile.bytes = bytes;
+        stages_.emplace_back(stage, profile);
+    }
+
+    std::vector<std::pair<std::string, StageProfile>> stages() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stages_;
+    }
+
+    /**
+     * @brief profile as one line of json: { "stage": { "calls": n, "wall_ns": n, "cpu_ns": n, "bytes": n }, ... }
+     */
+    std::string to_json() const {
+        std::string json = "{";
+        bool first = true;
+        for (const auto& entry : stages()) {
+            if (!first) json += ", ";
+            first = false;
+            json += "\"" + entry.first + "\": { \"calls\": " + std::to_string(entry.second.calls);
+            json += ", \"wall_ns\": " + std::to_string(entry.second.wall_ns);
+            json += ", \"cpu_ns\": " + std::to_string(entry.second.cpu_ns);
+            json += ", \"bytes\": " + std::to_string(entry.second.bytes) + " }";
+        }
+        return json + "}";
+    }
+};
+
+/**
+ * @brief Records wall and cpu time of its scope as one call of the given stage
+ */
+class ScopedTimer {
+    const char* stage_;
+    bool active_;
+    uint64_t wall_;
+    uint64_t cpu_;
+    uint64_t bytes_;
+
+ public:
+    explicit ScopedTimer(const char* stage) : stage_(stage), active_(Profiler::enabled()), wall_(0), cpu_(0), bytes_(0) {
+        if (active_) {
+            wall_ = profile_wall_ns();
+            cpu_ = profile_cpu_ns();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (active_) {
+            uint64_t cpu = profile_cpu_ns() - cpu_;
+            Profiler::instance().record(stage_, profile_wall_ns() - wall_, cpu, bytes_);
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    void add_bytes(uint64_t bytes) {
+        bytes_ += bytes;
+    }
+};
+
+/**
+ * @brief Splits the time of a hot loop into alternating stages, e.g., tokenizing and aggregation per clause
+ * lap(i) assigns the wall time since the previous lap to stage i. Laps are accumulated locally and recorded once
+ * on destruction. The cpu time of the whole lifetime is distributed over the stages in proportion to their wall time,
+ * as reading the thread cpu clock per lap would cost more than most laps take.
+ */
+class LapTimer {
+    struct Lap {
+        const char* stage;
+        uint64_t calls;
+        uint64_t wall;
+        uint64_t bytes;
+    };
+    std::vector<Lap> laps_;
+    bool active_;
+    uint64_t last_;
+    uint64_t cpu_;
+
+ public:
+    explicit LapTimer(std::initializer_list<const char*> stages) : laps_(), active_(Profiler::enabled()), last_(0), cpu_(0) {
+        if (active_) {
+            for (const char* stage : stages) laps_.push_back(Lap { stage, 0, 0, 0 });
+            last_ = profile_wall_ns();
+            cpu_ = profile_cpu_ns();
+        }
+    }
+
+    ~LapTimer() {
+        if (active_) {
+            uint64_t cpu = profile_cpu_ns() - cpu_;
+            uint64_t wall = 0;
+            for (const Lap& lap : laps_) wall += lap.wall;
+            for (const Lap& lap : laps_) {
+                uint64_t share = wall > 0 ? static_cast<uint64_t>(static_cast<double>(cpu) * lap.wall / wall) : 0;
+                Profiler::instance().record(lap.stage, lap.wall, share, lap.bytes, lap.calls);
+            }
+        }
+    }
+
+    LapTimer(const LapTimer&) = delete;
+    LapTimer& operator=(const LapTimer&) = delete;
+
+    void lap(unsigned stage, uint64_t bytes = 0) {
+        if (active_) {
+            uint64_t now = profile_wall_ns();
+            laps_[stage].wall += now - last_;
+            laps_[stage].bytes += bytes;
+            ++laps_[stage].calls;
+            last_ = now;
+        }
+    }
+};
+
+#endif  // SRC_UTIL_PROFILER_H_
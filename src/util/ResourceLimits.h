@@ -24,6 +24,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <iostream>
 #include <cstdint>
 #include <exception>
+#include <memory>
 
 #ifdef _WIN32
     #include <Windows.h>
@@ -42,6 +43,9 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
     #endif
 #endif
 
+#include "src/util/Cancellation.h"
+#include "src/util/MemoryBudget.h"
+
 
 struct ResourceLimitsExceeded : public std::exception {
     const char* what() const throw() {
@@ -49,18 +53,6 @@ struct ResourceLimitsExceeded : public std::exception {
     }
 };
 
-struct TimeLimitExceeded : public std::exception {
-    const char* what() const throw() {
-        return "Exceeded Time Limit";
-    }
-};
-
-struct MemoryLimitExceeded : public std::exception {
-    const char* what() const throw() {
-        return "Exceeded Memory Limit";
-    }
-};
-
 struct FileSizeLimitExceeded : public std::exception {
     const char* what() const throw() {
         return "Exceeded File Size Limit";
@@ -73,38 +65,59 @@ struct ResourceLimitsNotSupported : public std::exception {
     }
 };
 
-struct rlimit cpu_limit;
-static void timeout(int signal) {
-    setrlimit(RLIMIT_CPU, &cpu_limit);
-    throw TimeLimitExceeded();
-}
-
-struct rlimit as_limit;
+static struct rlimit as_limit;
 static void memout() {
     setrlimit(RLIMIT_AS, &as_limit);
     throw MemoryLimitExceeded();
 }
 
-struct rlimit fsize_limit;
+static struct rlimit fsize_limit;
 static void fileout(int signal) {
     setrlimit(RLIMIT_FSIZE, &fsize_limit);
     throw FileSizeLimitExceeded();
 }
 
 
+/**
+ * Runtime limits are enforced cooperatively by a CancellationToken, and memory limits by a MemoryBudget,
+ * both become current in the calling thread with set_rlimits(). The memory limit is optionally also enforced
+ * for the whole process by the operating system, as is the file size limit.
+ */
 class ResourceLimits {
     unsigned rlim_;  // runtime limit (seconds)
     unsigned mlim_;  // memory limit (mega bytes)
     unsigned flim_;  // file size limit (mega bytes)
+    unsigned wlim_;  // wall-clock time limit (milli seconds)
 
     unsigned time_;
 
+    CancellationToken token_;
+    std::unique_ptr<CancellationScope> scope_;
+    MemoryBudget budget_;
+    std::unique_ptr<MemoryBudgetScope> budget_scope_;
+
  public:
-    explicit ResourceLimits(unsigned rlim = 0, unsigned mlim = 0, unsigned flim = 0)
-     : rlim_(rlim), mlim_(mlim), flim_(flim) {
+    /**
+     * @param cpu_time which cpu time counts towards the runtime limit of the cancellation token,
+     *  CpuTime::SCOPES if several tasks share one process, e.g., in the server
+     */
+    explicit ResourceLimits(unsigned rlim = 0, unsigned mlim = 0, unsigned flim = 0, unsigned wlim = 0, CpuTime cpu_time = CpuTime::PROCESS)
+     : rlim_(rlim), mlim_(mlim), flim_(flim), wlim_(wlim), token_(wlim, static_cast<uint64_t>(rlim) * 1000, cpu_time), scope_(),
+       budget_(static_cast<uint64_t>(mlim) << 20), budget_scope_() {
         time_ = get_cpu_time();
     }
 
+    ResourceLimits(const ResourceLimits&) = delete;
+    ResourceLimits& operator=(const ResourceLimits&) = delete;
+
+    CancellationToken& token() {
+        return token_;
+    }
+
+    MemoryBudget& budget() {
+        return budget_;
+    }
+
     unsigned get_runtime() const {
         return get_cpu_time() - time_;
     }
@@ -131,13 +144,23 @@ class ResourceLimits {
         if (!within_limits()) throw ResourceLimitsExceeded();
     }
 
-    void set_rlimits() const {
+    /**
+     * @param process_memory also limit the address space of the whole process, e.g., in the command line tool,
+     *  but not in the python module where several tasks share one process
+     */
+    void set_rlimits(bool process_memory = true) {
+        if ((rlim_ > 0 || wlim_ > 0) && !scope_) {
+            scope_.reset(new CancellationScope(&token_));
+        }
+        if (mlim_ > 0 && !budget_scope_) {
+            budget_scope_.reset(new MemoryBudgetScope(&budget_));
+        }
     #ifdef _WIN32
         throw ResourceLimitsNotSupported();
     #else
         struct rlimit limit;
 
-        if (mlim_ > 0) {
+        if (mlim_ > 0 && process_memory) {
             getrlimit(RLIMIT_AS, &limit);
             uint64_t mlim = static_cast<uint64_t>(mlim_) << 20;  // mega bytes to bytes
             if (mlim <= limit.rlim_max) {
@@ -161,24 +184,6 @@ class ResourceLimits {
             std::set_new_handler(memout);
         }
 
-        if (rlim_ > 0) {
-            getrlimit(RLIMIT_CPU, &limit);
-            uint64_t rlim = static_cast<uint64_t>(rlim_);  // seconds
-            if (rlim <= limit.rlim_max) {
-                limit.rlim_cur = rlim;
-            } else {
-                limit.rlim_cur = limit.rlim_max;
-            }
-
-            if (setrlimit(RLIMIT_CPU, &limit) != 0) {
-                std::cerr << "Warning: Runtime limit could not be set" << std::endl;
-            }
-
-            cpu_limit = limit;
-            cpu_limit.rlim_cur = limit.rlim_max;
-            signal(SIGXCPU, timeout);
-        }
-
         if (flim_ > 0) {
             getrlimit(RLIMIT_FSIZE, &limit);
             uint64_t flim = static_cast<uint64_t>(flim_) << 20;  // mega bytes to bytes
@@ -0,0 +1,239 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_RESULTCACHE_H_
+#define SRC_UTIL_RESULTCACHE_H_
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/md5/md5.h"
+
+// Version of identifiers and feature extractors, cached results of other versions are ignored
+#define GBDC_VERSION 1
+
+/**
+ * @brief Persistent cache for hashes and feature records.
+ *
+ * Results are stored per file identity, i.e., canonical path, size, modification time and inode.
+ * If the file did not change, looking up a result costs a stat() call instead of a full parse.
+ * Each entry is a small text file named after the md5 of the identity.
+ * Its first line repeats version and identity, each further line holds a 'key value' pair.
+ * Entries are replaced atomically, such that concurrent workers can share a cache directory.
+ * Updates are serialized by an exclusive lock on the cache directory, such that concurrent updates of an entry
+ * with different keys do not lose each other's lines.
+ * The cache is best-effort: any error during lookup or store is treated as a cache miss.
+ */
+class ResultCache {
+    std::string dir_;
+
+    // version and identity of the given file, empty if the file can not be stat'ed
+    std::string identity(const char* filename) const {
+        struct stat st;
+        if (stat(filename, &st) != 0 || !S_ISREG(st.st_mode)) {
+            return std::string();
+        }
+        std::error_code ec;
+        std::filesystem::path path = std::filesystem::canonical(filename, ec);
+        if (ec) return std::string();
+    #ifdef __APPLE__
+        uint64_t mtime = static_cast<uint64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+    #else
+        uint64_t mtime = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    #endif
+        return "gbdc " + std::to_string(GBDC_VERSION) + " " + std::to_string(st.st_size) + " " + std::to_string(mtime)
+            + " " + std::to_string(st.st_ino) + " " + path.string();
+    }
+
+    std::string entry_path(const std::string& id) const {
+        MD5 md5;
+        md5.consume(id.c_str(), id.length());
+        return dir_ + "/" + md5.produce();
+    }
+
+    // exclusive lock of the cache directory for its lifetime, held by at most one thread or process at a time
+    class DirectoryLock {
+        int fd_;
+
+     public:
+        explicit DirectoryLock(const std::string& dir) : fd_(::open(dir.c_str(), O_RDONLY | O_DIRECTORY)) {
+            while (fd_ >= 0 && flock(fd_, LOCK_EX) != 0) {
+                if (errno != EINTR) {
+                    ::close(fd_);
+                    fd_ = -1;
+                }
+            }
+        }
+
+        ~DirectoryLock() {
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        DirectoryLock(const DirectoryLock&) = delete;
+        DirectoryLock& operator=(const DirectoryLock&) = delete;
+
+        bool locked() const {
+            return fd_ >= 0;
+        }
+    };
+
+    // read all 'key value' lines of entry, return false if entry does not exist or belongs to other identity
+    bool read_entry(const std::string& id, std::vector<std::string>* lines) const {
+        std::ifstream in(entry_path(id));
+        std::string line;
+        if (!std::getline(in, line) || line != id) return false;
+        while (std::getline(in, line)) {
+            lines->push_back(line);
+        }
+        return true;
+    }
+
+    // replace the value of key in the entry of the given identity
+    void put_entry(const std::string& id, const char* key, const std::string& value) const {
+        std::string path = entry_path(id);
+        DirectoryLock lock(dir_);
+        if (!lock.locked()) return;
+        std::vector<std::string> lines;
+        read_entry(id, &lines);
+        std::string prefix = std::string(key) + " ";
+        lines.erase(std::remove_if(lines.begin(), lines.end(), [&prefix] (const std::string& line) {
+            return line.compare(0, prefix.length(), prefix) == 0;
+        }), lines.end());
+        lines.push_back(prefix + value);
+        // write to temporary file and rename, such that readers never see partial entries
+        std::string tmp = path + "." + std::to_string(getpid()) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream out(tmp, std::ofstream::out | std::ofstream::trunc);
+            out << id << "\n";
+            for (const std::string& line : lines) {
+                out << line << "\n";
+            }
+            if (!out.good()) {
+                out.close();
+                std::remove(tmp.c_str());
+                return;
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+        }
+    }
+
+    static const std::string& format(const std::string& value) {
+        return value;
+    }
+
+    static std::string format(const std::vector<double>& values) {
+        std::string value;
+        char buffer[32];
+        for (double val : values) {
+            int n = snprintf(buffer, sizeof(buffer), "%.17g ", val);
+            value.append(buffer, n);
+        }
+        return value;
+    }
+
+ public:
+    /**
+     * @brief Open result cache in the given directory
+     * @param directory cache directory, nullptr falls back to environment variable GBDC_CACHE, empty string disables the cache
+     */
+    explicit ResultCache(const char* directory = nullptr) : dir_() {
+        if (directory == nullptr) directory = std::getenv("GBDC_CACHE");
+        if (directory != nullptr && *directory != '\0') {
+            std::error_code ec;
+            std::filesystem::create_directories(directory, ec);
+            if (!ec) dir_ = directory;
+        }
+    }
+
+    bool enabled() const {
+        return !dir_.empty();
+    }
+
+    bool get(const char* filename, const char* key, std::string* value) const {
+        if (!enabled()) return false;
+        std::string id = identity(filename);
+        std::vector<std::string> lines;
+        if (id.empty() || !read_entry(id, &lines)) return false;
+        std::string prefix = std::string(key) + " ";
+        for (const std::string& line : lines) {
+            if (line.compare(0, prefix.length(), prefix) == 0) {
+                *value = line.substr(prefix.length());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool get(const char* filename, const char* key, std::vector<double>* values) const {
+        std::string value;
+        if (!get(filename, key, &value)) return false;
+        values->clear();
+        const char* str = value.c_str();
+        char* end = nullptr;
+        for (double val = std::strtod(str, &end); end != str; val = std::strtod(str, &end)) {
+            values->push_back(val);
+            str = end;
+        }
+        return true;
+    }
+
+    void put(const char* filename, const char* key, const std::string& value) const {
+        if (!enabled()) return;
+        std::string id = identity(filename);
+        if (id.empty()) return;
+        put_entry(id, key, value);
+    }
+
+    void put(const char* filename, const char* key, const std::vector<double>& values) const {
+        put(filename, key, format(values));
+    }
+
+    /**
+     * @brief Return cached result for key if present, otherwise compute and store it
+     * The result is stored only if the file did not change during the computation.
+     * @param compute function computing the result, returns std::string or std::vector<double>
+     */
+    template <typename F>
+    auto fetch(const char* filename, const char* key, F compute) const -> decltype(compute()) {
+        decltype(compute()) result;
+        if (get(filename, key, &result)) {
+            return result;
+        }
+        std::string id = enabled() ? identity(filename) : std::string();
+        result = compute();
+        if (!id.empty() && identity(filename) == id) put_entry(id, key, format(result));
+        return result;
+    }
+};
+
+#endif  // SRC_UTIL_RESULTCACHE_H_
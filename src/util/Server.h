@@ -0,0 +1,316 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_SERVER_H_
+#define SRC_UTIL_SERVER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "src/util/JsonLine.h"
+#include "src/util/ResourceLimits.h"
+#include "src/util/WorkQueue.h"
+
+/**
+ * @brief Answers requests in newline-delimited JSON on a Unix domain socket from a pool of worker threads
+ * Each line is one request, e.g., {"id": 1, "tool": "gbdhash", "file": "/path/to/instance.cnf.xz", "wallout": 1000},
+ * and is answered by one line with the request's "id" and "file", and either "result" or "error".
+ * Responses are sent as soon as they are ready, i.e., not necessarily in the order of the requests.
+ * Limits "timeout" (cpu seconds), "wallout" (milliseconds), and "memout" (megabytes) apply per request,
+ * with the limits given to the server as defaults, and are enforced by the cancellation token and memory budget of the worker.
+ */
+class Server {
+ public:
+    /**
+     * @brief computes the result of a request as JSON text, throws on failure
+     */
+    using Handler = std::function<std::string(const JsonObject& request)>;
+
+    struct Limits {
+        unsigned timeout;  // cpu seconds
+        unsigned wallout;  // milli seconds
+        unsigned memout;  // mega bytes
+
+        Limits() : timeout(0), wallout(0), memout(0) { }
+    };
+
+    static constexpr size_t max_line = 1 << 20;
+
+ private:
+    struct Connection {
+        int fd;
+        std::mutex mutex;
+
+        explicit Connection(int fd) : fd(fd), mutex() { }
+
+        ~Connection() {
+            ::close(fd);
+        }
+
+        // send one line, failures (client gone) are ignored
+        void send(const std::string& line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t done = 0;
+            while (done < line.size()) {
+                ssize_t length = ::send(fd, line.data() + done, line.size() - done, MSG_NOSIGNAL);
+                if (length < 0 && errno == EINTR) continue;
+                if (length <= 0) return;
+                done += length;
+            }
+        }
+    };
+
+    struct Task {
+        std::shared_ptr<Connection> connection;
+        std::string line;
+    };
+
+    struct Reader {
+        std::thread thread;
+        std::weak_ptr<Connection> connection;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    std::string path_;
+    unsigned threads_;
+    Handler handler_;
+    Limits defaults_;
+
+    int listen_fd_;
+    int stop_pipe_[2];
+    std::atomic<bool> stopping_;
+
+    WorkQueue<Task> tasks_;
+    std::vector<std::thread> workers_;
+    std::vector<Reader> readers_;
+
+    static Server*& signal_target() {
+        static Server* server = nullptr;
+        return server;
+    }
+
+    static void on_signal(int) {
+        if (signal_target() != nullptr) signal_target()->stop();
+    }
+
+    std::string error(const std::string& head, const std::string& message) const {
+        return head + "\"error\": " + json_string(message) + "}\n";
+    }
+
+    std::string respond(const std::string& line) const {
+        std::string head = "{";
+        try {
+            JsonObject request(line);
+            if (request.has("id")) head += "\"id\": " + request.raw("id") + ", ";
+            if (request.has("file")) head += "\"file\": " + request.raw("file") + ", ";
+            if (stopping_) return error(head, "server shutting down");
+            ResourceLimits limits(request.get_uint("timeout", defaults_.timeout, UINT_MAX), request.get_uint("memout", defaults_.memout, UINT_MAX), 0,
+                request.get_uint("wallout", defaults_.wallout, UINT_MAX), CpuTime::SCOPES);
+            limits.set_rlimits(false);
+            std::string result = handler_(request);
+            return head + "\"result\": " + result + "}\n";
+        }
+        catch (TimeLimitExceeded& e) {
+            return error(head, "timeout");
+        }
+        catch (MemoryLimitExceeded& e) {
+            return error(head, "memout");
+        }
+        catch (std::bad_alloc& e) {
+            return error(head, "memout");
+        }
+        catch (JsonError& e) {
+            return error(head, std::string("invalid request: ") + e.what());
+        }
+        catch (std::exception& e) {
+            return error(head, e.what());
+        }
+    }
+
+    void work() {
+        Task task;
+        while (tasks_.pop(task)) {
+            task.connection->send(respond(task.line));
+            task.connection.reset();  // close connection if this was its last pending request
+        }
+    }
+
+    // split the input of one client into requests, until the client closes its end of the connection
+    void read(std::shared_ptr<Connection> connection) {
+        std::string pending;
+        std::vector<char> buffer(1 << 16);
+        for (;;) {
+            ssize_t length = ::recv(connection->fd, buffer.data(), buffer.size(), 0);
+            if (length < 0 && errno == EINTR) continue;
+            if (length <= 0) break;
+            pending.append(buffer.data(), length);
+            size_t begin = 0;
+            for (size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', begin)) {
+                std::string line = pending.substr(begin, end - begin);
+                begin = end + 1;
+                if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+                if (!tasks_.push({ connection, std::move(line) })) return;
+            }
+            pending.erase(0, begin);
+            if (pending.size() > max_line) {
+                connection->send(error("{", "invalid request: line too long"));
+                return;
+            }
+        }
+        if (pending.find_first_not_of(" \t\r") != std::string::npos) tasks_.push({ connection, pending });
+    }
+
+    void accept_connection() {
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) return;
+        // join readers of closed connections
+        for (size_t i = 0; i < readers_.size(); ) {
+            if (*readers_[i].done) {
+                readers_[i].thread.join();
+                readers_[i] = std::move(readers_.back());
+                readers_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+        std::shared_ptr<std::atomic<bool>> done = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread([this, connection, done] () mutable {
+            read(std::move(connection));
+            *done = true;
+        });
+        readers_.push_back({ std::move(thread), connection, done });
+    }
+
+ public:
+    /**
+     * @param path of the socket, an existing socket at path is replaced
+     * @param threads number of worker threads, 0 for one per core
+     * @param handler computes the result of a request
+     * @param defaults limits of requests which do not give their own
+     * @throw std::runtime_error if the socket can not be created
+     */
+    Server(const std::string& path, unsigned threads, Handler handler, Limits defaults = Limits())
+     : path_(path), threads_(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())), handler_(std::move(handler)),
+       defaults_(defaults), listen_fd_(-1), stop_pipe_{ -1, -1 }, stopping_(false), tasks_(4 * threads_), workers_(), readers_() {
+        struct sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path_.size() >= sizeof(address.sun_path)) throw std::runtime_error("Socket path too long: " + path_);
+        std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+
+        struct stat st;
+        if (::lstat(path_.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) throw std::runtime_error("Not a socket: " + path_);
+            ::unlink(path_.c_str());
+        }
+        if (::pipe(stop_pipe_) != 0) throw std::runtime_error("Error creating pipe");
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listen_fd_, 64) != 0) {
+            std::string error = std::string(std::strerror(errno)) + ": " + path_;
+            if (listen_fd_ >= 0) ::close(listen_fd_);
+            ::close(stop_pipe_[0]);
+            ::close(stop_pipe_[1]);
+            throw std::runtime_error("Error creating socket: " + error);
+        }
+    }
+
+    ~Server() {
+        if (signal_target() == this) signal_target() = nullptr;
+        ::close(listen_fd_);
+        ::unlink(path_.c_str());
+        ::close(stop_pipe_[0]);
+        ::close(stop_pipe_[1]);
+    }
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    unsigned threads() const {
+        return threads_;
+    }
+
+    /**
+     * @brief accept connections and answer requests until stop() is called
+     * Requests which are queued at that time are answered with an error, running ones are completed.
+     */
+    void run() {
+        for (unsigned i = 0; i < threads_; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+        struct pollfd fds[2] = { { listen_fd_, POLLIN, 0 }, { stop_pipe_[0], POLLIN, 0 } };
+        while (!stopping_) {
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (fds[1].revents != 0) break;
+            if (fds[0].revents & POLLIN) accept_connection();
+        }
+        stopping_ = true;
+        for (Reader& reader : readers_) {
+            std::shared_ptr<Connection> connection = reader.connection.lock();
+            if (connection) ::shutdown(connection->fd, SHUT_RD);
+        }
+        for (Reader& reader : readers_) reader.thread.join();
+        readers_.clear();
+        tasks_.close();
+        for (std::thread& worker : workers_) worker.join();
+        workers_.clear();
+    }
+
+    /**
+     * @brief let run() return, can be called from any thread and from signal handlers
+     */
+    void stop() {
+        stopping_ = true;
+        char c = 0;
+        if (::write(stop_pipe_[1], &c, 1) < 0) { }
+    }
+
+    /**
+     * @brief stop this server on SIGINT and SIGTERM
+     */
+    void stop_on_signals() {
+        signal_target() = this;
+        signal(SIGINT, on_signal);
+        signal(SIGTERM, on_signal);
+    }
+};
+
+#endif  // SRC_UTIL_SERVER_H_
@@ -0,0 +1,155 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_SPILLBUFFER_H_
+#define SRC_UTIL_SPILLBUFFER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "src/util/MemoryBudget.h"
+#include "src/util/NumberFormat.h"
+#include "src/util/ResourceLimits.h"
+#include "src/util/StreamWriter.h"
+
+/**
+ * @brief Holds generated output whose header is only known at the end, e.g., the clause count
+ * The data is kept in memory up to the given limit or until the memory budget of the task is exhausted,
+ * beyond that it is spilled to an anonymous temporary file. Once the header is written, copy_to() appends
+ * the data to the actual output.
+ */
+class SpillBuffer {
+    std::vector<char> buffer;
+    size_t pos;
+    size_t limit_;
+    FILE* spill_;
+    MemoryAccount memory;
+
+    void spill() {
+        if (spill_ == nullptr) {
+            spill_ = std::tmpfile();
+            if (spill_ == nullptr) {
+                throw std::runtime_error("Error creating temporary file");
+            }
+        }
+        if (std::fwrite(buffer.data(), 1, pos, spill_) != pos) {
+            throw FileSizeLimitExceeded();
+        }
+        pos = 0;
+    }
+
+    // afterwards pos + length fits into the buffer, unless length itself does not
+    void reserve(size_t length) {
+        if (pos + length <= buffer.size()) return;
+        if (buffer.size() < limit_) {
+            size_t size = std::min(limit_, std::max(2 * buffer.size(), pos + length));
+            try {
+                memory.set(size);
+                buffer.resize(size);
+            } catch (MemoryLimitExceeded& e) {
+                limit_ = buffer.size();
+            }
+            if (pos + length <= buffer.size()) return;
+        }
+        spill();
+    }
+
+ public:
+    /**
+     * @param limit number of bytes which are kept in memory before spilling to disk
+     */
+    explicit SpillBuffer(size_t limit = 1 << 26) : buffer(std::min(limit, size_t(1) << 16)), pos(0), limit_(limit), spill_(nullptr), memory() {
+        memory.charge(buffer.size());
+    }
+
+    ~SpillBuffer() {
+        // temporary file is removed on close
+        if (spill_ != nullptr) std::fclose(spill_);
+    }
+
+    SpillBuffer(const SpillBuffer&) = delete;
+    SpillBuffer& operator=(const SpillBuffer&) = delete;
+
+    /**
+     * @return true if data was written to the temporary file
+     */
+    bool spilled() const {
+        return spill_ != nullptr;
+    }
+
+    void write(const char* str, size_t length) {
+        reserve(length);
+        if (pos + length > buffer.size()) {
+            spill();
+            if (std::fwrite(str, 1, length, spill_) != length) {
+                throw FileSizeLimitExceeded();
+            }
+            return;
+        }
+        std::memcpy(buffer.data() + pos, str, length);
+        pos += length;
+    }
+
+    void put(char c) {
+        reserve(1);
+        buffer[pos++] = c;
+    }
+
+    void write_int(int64_t value) {
+        reserve(21);
+        pos += format_int(buffer.data() + pos, value);
+    }
+
+    /**
+     * @brief write clause as one line of DIMACS literals terminated by 0
+     */
+    void write_clause(const std::vector<int>& clause) {
+        for (int lit : clause) {
+            reserve(12);
+            pos += format_int(buffer.data() + pos, lit);
+            buffer[pos++] = ' ';
+        }
+        write("0\n", 2);
+    }
+
+    /**
+     * @brief append all data to the given output, the buffer is empty afterwards
+     */
+    void copy_to(StreamWriter& out) {
+        if (spill_ == nullptr) {
+            out.write(buffer.data(), pos);
+            pos = 0;
+            return;
+        }
+        spill();
+        std::rewind(spill_);
+        size_t length;
+        while ((length = std::fread(buffer.data(), 1, buffer.size(), spill_)) > 0) {
+            out.write(buffer.data(), length);
+        }
+        std::fclose(spill_);
+        spill_ = nullptr;
+    }
+};
+
+#endif  // SRC_UTIL_SPILLBUFFER_H_
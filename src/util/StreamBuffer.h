@@ -27,9 +27,18 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <limits>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "SolverTypes.h"
+#include "Profiler.h"
+#include "Cancellation.h"
+#include "BlockDecompressor.h"
 
 class ParserException : public std::exception {
  public:
@@ -42,8 +51,61 @@ class ParserException : public std::exception {
     std::string m_what;
 };
 
+/**
+ * @brief Registers a memory region, compressed or not, under a name which can be passed wherever a filename is expected
+ * The region is read in place, it must stay valid and unchanged while registered, i.e., for the lifetime of MemoryFile.
+ */
+class MemoryFile {
+    std::string name_;
+
+    static std::mutex& mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::unordered_map<std::string, std::pair<const char*, size_t>>& registry() {
+        static std::unordered_map<std::string, std::pair<const char*, size_t>> registry;
+        return registry;
+    }
+
+ public:
+    MemoryFile(const void* data, size_t size) : name_() {
+        static std::atomic<uint64_t> counter(0);
+        name_ = "<memory:" + std::to_string(counter++) + ">";
+        std::lock_guard<std::mutex> lock(mutex());
+        registry().emplace(name_, std::make_pair(static_cast<const char*>(data), size));
+    }
+
+    ~MemoryFile() {
+        std::lock_guard<std::mutex> lock(mutex());
+        registry().erase(name_);
+    }
+
+    MemoryFile(const MemoryFile&) = delete;
+    MemoryFile& operator=(const MemoryFile&) = delete;
+
+    const char* name() const {
+        return name_.c_str();
+    }
+
+    /**
+     * @brief look up the region registered under the given name
+     * @return false if name is not registered, e.g., if it is the path of a file
+     */
+    static bool find(const char* name, const char** data, size_t* size) {
+        if (name[0] != '<') return false;
+        std::lock_guard<std::mutex> lock(mutex());
+        auto it = registry().find(name);
+        if (it == registry().end()) return false;
+        *data = it->second.first;
+        *size = it->second.second;
+        return true;
+    }
+};
+
 class StreamBuffer {
     struct archive* file;
+    std::unique_ptr<BlockDecompressor> blocks;  // replaces file for inputs which are decompressed in parallel
 
     unsigned int buffer_size;
     char* buffer;
@@ -56,6 +118,8 @@ class StreamBuffer {
 
     bool refill_buffer(bool align = true) {
         if (pos >= end && !end_of_file) {
+            check_cancellation();
+            ScopedTimer timer("decompress");
             pos = 0;
             if (end > 0 && end < buffer_size) {
                 std::copy(buffer + end, buffer + buffer_size, buffer);
@@ -63,7 +127,13 @@ class StreamBuffer {
             } else {
                 end = 0;
             }
-            end += archive_read_data(file, buffer + end, buffer_size - end);
+            la_ssize_t length = blocks ? read_blocks(buffer + end, buffer_size - end) : archive_read_data(file, buffer + end, buffer_size - end);
+            if (length < 0) {
+                const char* error = file != nullptr ? archive_error_string(file) : nullptr;
+                throw ParserException(std::string(error != nullptr ? error : "unknown error") + std::string(" Error reading file: ") + std::string(filename_));
+            }
+            end += length;
+            timer.add_bytes(length);
             if (end < buffer_size) {
                 std::memset(buffer + end, 0, buffer_size - end);
                 end_of_file = true;
@@ -87,27 +157,68 @@ class StreamBuffer {
         }
     }
 
- public:
-    explicit StreamBuffer(const char* filename) : buffer_size(16384), pos(0), end(0), end_of_file(false), filename_(filename) {
+    la_ssize_t read_blocks(char* out, size_t length) {
+        try {
+            return blocks->read(out, length);
+        } catch (DecompressionError& e) {
+            throw ParserException(std::string(e.what()) + std::string(": ") + std::string(filename_));
+        }
+    }
+
+    // open the given memory region, or the file filename_ if data is nullptr
+    void open(const char* data, size_t size) {
+        blocks = BlockDecompressor::open(filename_, data, size);
+        if (blocks) {
+            file = nullptr;
+            buffer = new char[buffer_size];
+            refill_buffer();
+            return;
+        }
         file = archive_read_new();
         archive_read_support_filter_all(file);
         // archive_read_support_format_raw(file);
         archive_read_support_format_raw(file);
-        int r = archive_read_open_filename(file, filename, buffer_size);
+        int r = data != nullptr ? archive_read_open_memory(file, data, size) : archive_read_open_filename(file, filename_, buffer_size);
         if (r != ARCHIVE_OK) {
-            throw ParserException(std::string(archive_error_string(file)) + std::string(" Error opening file: ") + std::string(filename));
+            std::string error = std::string(archive_error_string(file)) + std::string(" Error opening file: ") + std::string(filename_);
+            archive_read_free(file);
+            throw ParserException(error);
         }
         struct archive_entry *entry;
         r = archive_read_next_header(file, &entry);
         if (r != ARCHIVE_OK) {
-            throw ParserException(std::string("Error reading header: ") + std::string(filename));
+            archive_read_free(file);
+            throw ParserException(std::string("Error reading header: ") + std::string(filename_));
         }
         buffer = new char[buffer_size];
         refill_buffer();
     }
 
+ public:
+    /**
+     * @param filename path of file, or name of a MemoryFile
+     */
+    explicit StreamBuffer(const char* filename) : buffer_size(16384), pos(0), end(0), end_of_file(false), filename_(filename) {
+        const char* data = nullptr;
+        size_t size = 0;
+        MemoryFile::find(filename, &data, &size);
+        open(data, size);
+    }
+
+    /**
+     * @brief read from memory, compressed or not
+     * @param name used in error messages
+     */
+    StreamBuffer(const char* data, size_t size, const char* name = "<memory>")
+     : buffer_size(16384), pos(0), end(0), end_of_file(false), filename_(name) {
+        open(data, size);
+    }
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
     ~StreamBuffer() {
-        archive_read_free(file);
+        if (file != nullptr) archive_read_free(file);
         delete[] buffer;
     }
 
@@ -313,6 +424,27 @@ class StreamBuffer {
         return true;
     }
 
+    /**
+     * @brief read a block of complete lines, i.e., at least size bytes and up to the next linebreak
+     * @param out the read block, output parameter
+     * @param size minimum block size (unless eof is reached)
+     * @return true if block was read, false if eof was already reached
+     */
+    bool readLines(std::vector<char>& out, size_t size) {
+        out.clear();
+        if (eof()) return false;
+        while (out.size() < size) {
+            out.insert(out.end(), buffer + pos, buffer + end);
+            pos = end;
+            if (!refill_buffer()) break;
+        }
+        while (!eof() && buffer[pos] != '\n') {
+            out.push_back(buffer[pos]);
+            skip();
+        }
+        return true;
+    }
+
     /**
      * @brief read next clause
      * @param out the read clause, output parameter
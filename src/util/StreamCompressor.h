@@ -23,8 +23,15 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <archive.h>
 #include <archive_entry.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+
+#include "src/util/ResourceLimits.h"
 
 class StreamCompressorException : public std::runtime_error
 {
@@ -34,35 +41,118 @@ public:
     explicit StreamCompressorException(const std::string &msg, archive *arch) : std::runtime_error(msg + ": " + std::string(archive_error_string(arch))) {}
 };
 
+/**
+ * Settings of the compression filter, unset fields select the defaults of the filter
+ */
+struct CompressionOptions
+{
+    std::string filter;    // xz, lzma, zstd, gzip, bzip2, or none; empty: chosen by extension of output path
+    int level = -1;        // compression level, -1: default level of the filter
+    unsigned threads = 1;  // number of threads for xz and zstd, 0: one per core
+};
+
+/**
+ * Writes a single compressed file. The filter is chosen by the extension of the output path:
+ * .xz, .lzma, .zst, .gz, or .bz2, other paths are written uncompressed. Filter, level and number of
+ * threads can be overridden by CompressionOptions.
+ * If a size is given, writing more than announced is an error. Otherwise, the size of the
+ * stream is unknown up front and data can be written until close() is called.
+ */
 class StreamCompressor
 {
-    unsigned size_;
-    unsigned cursor;
+    size_t size_;
+    size_t cursor;
 
     struct archive *arch;
     struct archive_entry *entry;
 
     int status;
+    bool closed_;
+
+    void add_filter(const std::string &ext, const CompressionOptions &options)
+    {
+        std::string filter = options.filter;
+        if (filter.empty())
+        {
+            if (ext == ".xz")
+                filter = "xz";
+            else if (ext == ".lzma")
+                filter = "lzma";
+            else if (ext == ".zst")
+                filter = "zstd";
+            else if (ext == ".gz")
+                filter = "gzip";
+            else if (ext == ".bz2")
+                filter = "bzip2";
+            else
+                filter = "none";
+        }
+        if (filter == "xz")
+            status = archive_write_add_filter_xz(arch);
+        else if (filter == "lzma")
+            status = archive_write_add_filter_lzma(arch);
+        else if (filter == "zstd")
+            status = archive_write_add_filter_zstd(arch);
+        else if (filter == "gzip")
+            status = archive_write_add_filter_gzip(arch);
+        else if (filter == "bzip2")
+            status = archive_write_add_filter_bzip2(arch);
+        else if (filter == "none")
+            status = archive_write_add_filter_none(arch);
+        else
+            throw StreamCompressorException("Unknown compression filter: " + filter);
+        // ARCHIVE_WARN: filter is run as external program
+        if (status < ARCHIVE_WARN)
+            throw StreamCompressorException("Error adding " + filter + " filter", arch);
+        if (filter == "none")
+            return;
+
+        if (options.level >= 0)
+        {
+            status = archive_write_set_filter_option(arch, nullptr, "compression-level", std::to_string(options.level).c_str());
+            if (status != ARCHIVE_OK)
+                throw StreamCompressorException("Error setting compression level", arch);
+        }
+        if (options.threads != 1 && (filter == "xz" || filter == "zstd"))
+        {
+            unsigned threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+            status = archive_write_set_filter_option(arch, nullptr, "threads", std::to_string(threads).c_str());
+            if (status != ARCHIVE_OK)
+                throw StreamCompressorException("Error setting number of compression threads", arch);
+        }
+    }
+
+    void check_write(int status, const char *msg)
+    {
+        if (status < ARCHIVE_WARN)
+        {
+            if (archive_errno(arch) == EFBIG)
+                throw FileSizeLimitExceeded();
+            throw StreamCompressorException(msg, arch);
+        }
+    }
 
 public:
-    StreamCompressor(const char *output, unsigned size = 0) : size_(size), cursor(0), status(0)
+    StreamCompressor(const char *output, size_t size = 0, const CompressionOptions &options = CompressionOptions())
+        : size_(size), cursor(0), status(0), closed_(false)
     {
+        std::filesystem::path p(output);
+
         arch = archive_write_new();
         status = archive_write_set_format_raw(arch);
         if (status != ARCHIVE_OK)
             throw StreamCompressorException("Error setting format", arch);
-        status = archive_write_add_filter_xz(arch);
-        if (status != ARCHIVE_OK)
-            throw StreamCompressorException("Error adding XZ filter", arch);
+        add_filter(p.extension().string(), options);
+        // do not pad the last block of compressed output with zeros
+        archive_write_set_bytes_in_last_block(arch, 1);
         status = archive_write_open_filename(arch, output);
         if (status != ARCHIVE_OK)
             throw StreamCompressorException("Error open archive", arch);
 
         entry = archive_entry_new();
 
-        std::filesystem::path p(output);
         auto entry_path = p.filename();
-        if (entry_path.extension() == ".xz")
+        if (is_compressed(output))
         {
             entry_path.replace_extension();
         }
@@ -80,21 +170,34 @@ public:
 
     ~StreamCompressor()
     {
+        if (!closed_)
+        {
+            archive_entry_free(entry);
+            archive_write_free(arch);
+        }
     }
 
-    void write(const char *buf, unsigned len)
+    /**
+     * @brief check if the given output path is written compressed
+     */
+    static bool is_compressed(const char *output)
+    {
+        std::string ext = std::filesystem::path(output).extension().string();
+        return ext == ".xz" || ext == ".lzma" || ext == ".zst" || ext == ".gz" || ext == ".bz2";
+    }
+
+    void write(const char *buf, size_t len)
     {
         cursor += len;
-        if (cursor > size_)
+        if (size_ > 0 && cursor > size_)
         {
             throw StreamCompressorException("Attempt to write more than announced");
         }
-    
-        int bytes_written = archive_write_data(arch, buf, len);
-        if (bytes_written != len)
+
+        la_ssize_t bytes_written = archive_write_data(arch, buf, len);
+        if (bytes_written < 0 || static_cast<size_t>(bytes_written) != len)
         {
-            std::cerr << archive_error_string << "\n";
-            throw StreamCompressorException("Error writing to archive", arch);
+            check_write(ARCHIVE_FATAL, "Error writing to archive");
         }
     }
 
@@ -107,7 +210,7 @@ public:
     friend std::istream &operator>>(std::istream &input, StreamCompressor &cmpr)
     {
         input.seekg(0, input.end);
-        unsigned length = input.tellg();
+        size_t length = input.tellg();
         input.seekg(0, input.beg);
 
         char *buffer = new char[length];
@@ -116,7 +219,7 @@ public:
         {
             throw StreamCompressorException("Error reading from input stream");
         }
-        if (archive_entry_size(cmpr.entry) < length)
+        if (static_cast<size_t>(archive_entry_size(cmpr.entry)) < length)
         {
             cmpr.resize_entry(length);
         }
@@ -129,16 +232,22 @@ public:
 
     void close()
     {
+        closed_ = true;
         archive_entry_free(entry);
         status = archive_write_close(arch);
         if (status != ARCHIVE_OK)
         {
-            throw StreamCompressorException("Error closing archive", arch);
+            StreamCompressorException error("Error closing archive", arch);
+            int err = archive_errno(arch);
+            archive_write_free(arch);
+            if (err == EFBIG)
+                throw FileSizeLimitExceeded();
+            throw error;
         }
         status = archive_write_free(arch);
         if (status != ARCHIVE_OK)
         {
-            throw StreamCompressorException("Error freeing archive", arch);
+            throw StreamCompressorException("Error freeing archive");
         }
     }
 };
@@ -0,0 +1,166 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_STREAMWRITER_H_
+#define SRC_UTIL_STREAMWRITER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/util/NumberFormat.h"
+#include "src/util/ResourceLimits.h"
+#include "src/util/StreamCompressor.h"
+
+/**
+ * @brief Buffered writer for large generated files
+ * Output is assembled in a large block which is handed to the file once it is full,
+ * integers are formatted by hand and lines are never flushed individually.
+ * Paths with extension .xz, .lzma, .zst, .gz, or .bz2 are compressed on the fly by StreamCompressor.
+ * A short write, e.g., when the file size limit is reached, is reported as FileSizeLimitExceeded.
+ */
+class StreamWriter {
+    FILE* file_;
+    bool owned_;
+    std::unique_ptr<StreamCompressor> compressor_;
+    bool closed_;
+
+    std::vector<char> buffer;
+    size_t pos;
+
+    void write_block(const char* data, size_t length) {
+        if (compressor_) {
+            compressor_->write(data, length);
+        } else if (std::fwrite(data, 1, length, file_) != length) {
+            throw FileSizeLimitExceeded();
+        }
+    }
+
+ public:
+    /**
+     * @param filename path of output file, nullptr or "-" for stdout
+     * @param options compression settings, by default the filter is chosen by the extension of filename
+     * @param block_size size of the blocks handed to the file
+     */
+    explicit StreamWriter(const char* filename = nullptr, const CompressionOptions& options = CompressionOptions(), size_t block_size = 1 << 20)
+     : file_(stdout), owned_(false), compressor_(), closed_(false), buffer(block_size), pos(0) {
+        if (filename != nullptr && std::strcmp(filename, "-") != 0) {
+            bool compress = options.filter.empty() ? StreamCompressor::is_compressed(filename) : options.filter != "none";
+            if (compress) {
+                compressor_.reset(new StreamCompressor(filename, 0, options));
+                file_ = nullptr;
+            } else {
+                file_ = std::fopen(filename, "wb");
+                if (file_ == nullptr) {
+                    throw std::runtime_error(std::string("Error opening output file: ") + filename);
+                }
+                owned_ = true;
+            }
+        }
+    }
+
+    ~StreamWriter() {
+        // no exceptions during unwinding, errors are only reported by close()
+        if (!closed_) {
+            try {
+                close();
+            } catch (...) { }
+        }
+    }
+
+    /**
+     * @throw TimeLimitExceeded if the current cancellation token expired
+     */
+    void flush() {
+        check_cancellation();
+        size_t length = pos;
+        pos = 0;
+        if (length > 0) write_block(buffer.data(), length);
+    }
+
+    /**
+     * @brief flush and close the file
+     * @throw FileSizeLimitExceeded if not all data could be written
+     */
+    void close() {
+        if (closed_) return;
+        closed_ = true;
+        try {
+            flush();
+        } catch (...) {
+            if (owned_) std::fclose(file_);
+            throw;
+        }
+        if (compressor_) {
+            compressor_->close();
+        } else if ((owned_ ? std::fclose(file_) : std::fflush(file_)) != 0) {
+            throw FileSizeLimitExceeded();
+        }
+    }
+
+    void write(const char* str, size_t length) {
+        if (pos + length > buffer.size()) {
+            flush();
+            if (length > buffer.size()) {
+                write_block(str, length);
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + pos, str, length);
+        pos += length;
+    }
+
+    void write(const std::string& str) {
+        write(str.data(), str.length());
+    }
+
+    void put(char c) {
+        if (pos == buffer.size()) flush();
+        buffer[pos++] = c;
+    }
+
+    void write_uint(uint64_t value) {
+        if (pos + 20 > buffer.size()) flush();
+        pos += format_uint(buffer.data() + pos, value);
+    }
+
+    void write_int(int64_t value) {
+        if (pos + 21 > buffer.size()) flush();
+        pos += format_int(buffer.data() + pos, value);
+    }
+
+    /**
+     * @brief write line "a b 0\n", e.g., an edge or a binary clause
+     */
+    void write_pair(uint64_t a, uint64_t b) {
+        if (pos + 44 > buffer.size()) flush();
+        char* out = buffer.data() + pos;
+        out += format_uint(out, a);
+        *out++ = ' ';
+        out += format_uint(out, b);
+        std::memcpy(out, " 0\n", 3);
+        pos = out + 3 - buffer.data();
+    }
+};
+
+#endif  // SRC_UTIL_STREAMWRITER_H_
@@ -0,0 +1,156 @@
+/*************************************************************************************************
+CNFTools -- Copyright (c) 2024, Markus Iser, KIT - Karlsruhe Institute of Technology
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+#ifndef SRC_UTIL_WORKQUEUE_H_
+#define SRC_UTIL_WORKQUEUE_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Blocking multi-producer multi-consumer queue
+ * push() blocks while the queue is full, pop() blocks while it is empty.
+ * After close(), push() fails and pop() drains the remaining items.
+ */
+template <typename T>
+class WorkQueue {
+    std::deque<T> items;
+    size_t capacity_;
+    bool closed_;
+
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+ public:
+    /**
+     * @param capacity maximum number of queued items, 0 for unbounded
+     */
+    explicit WorkQueue(size_t capacity = 0) : items(), capacity_(capacity), closed_(false) { }
+
+    /**
+     * @brief enqueue item, block while queue is full
+     * @return false if queue was closed (item is dropped)
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed_ || capacity_ == 0 || items.size() < capacity_; });
+        if (closed_) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief dequeue item, block while queue is empty and open
+     * @return false if queue is closed and empty
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed_ || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed_ = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+};
+
+/**
+ * @brief Blocking queue which hands out items in the order of their sequence numbers
+ * Workers push results out of order, a single consumer pops them in order 0, 1, 2, ...
+ * push() blocks while the sequence number is capacity or more ahead of the next item to pop,
+ * this bounds the number of buffered results if one worker lags behind.
+ * After close(), push() fails and pop() drains the remaining items up to the first gap.
+ */
+template <typename T>
+class OrderedQueue {
+    std::map<size_t, T> items;
+    size_t next_;
+    size_t capacity_;
+    bool closed_;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable not_full;
+
+ public:
+    /**
+     * @param capacity maximum distance of pushed sequence numbers to the next one to pop, 0 for unbounded
+     */
+    explicit OrderedQueue(size_t capacity = 0) : items(), next_(0), capacity_(capacity), closed_(false) { }
+
+    /**
+     * @brief enqueue item with given sequence number, block while it is too far ahead
+     * @return false if queue was closed (item is dropped)
+     */
+    bool push(size_t seq, T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this, seq] { return closed_ || capacity_ == 0 || seq < next_ + capacity_; });
+        if (closed_) return false;
+        items.emplace(seq, std::move(item));
+        if (seq == next_) ready.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief dequeue item with next sequence number, block until it is available
+     * @return false if queue is closed and next item is missing
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return closed_ || (!items.empty() && items.begin()->first == next_); });
+        if (items.empty() || items.begin()->first != next_) return false;
+        item = std::move(items.begin()->second);
+        items.erase(items.begin());
+        ++next_;
+        not_full.notify_all();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed_ = true;
+        ready.notify_all();
+        not_full.notify_all();
+    }
+};
+
+/**
+ * @brief number of worker threads to use for parallel stages
+ * @param max upper bound on the number of threads
+ */
+inline unsigned num_workers(unsigned max = 8) {
+    unsigned hw = std::thread::hardware_concurrency();
+    return std::max(1u, std::min(hw, max));
+}
+
+#endif  // SRC_UTIL_WORKQUEUE_H_
@@ -22,6 +22,15 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include "Python.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <vector>
+
+#include "src/util/StreamBuffer.h"
+
 static PyObject* pytype(int val) {
     return Py_BuildValue("i", val);
 }
@@ -30,6 +39,10 @@ static PyObject* pytype(unsigned val) {
     return Py_BuildValue("I", val);
 }
 
+static PyObject* pytype(uint64_t val) {
+    return PyLong_FromUnsignedLongLong(val);
+}
+
 static PyObject* pytype(const char* val) {
     return Py_BuildValue("s", val);
 }
@@ -38,32 +51,211 @@ static PyObject* pytype(double val) {
     return PyFloat_FromDouble(val);
 }
 
+/**
+ * The builders below take care of reference counts: values are created and released by the builders,
+ * keys are interned once and kept for the lifetime of the module.
+ */
+
+/**
+ * @brief interned string for the given key, created once per distinct key
+ * @return borrowed reference
+ */
+static PyObject* pykey(const char* key) {
+    static std::unordered_map<std::string, PyObject*> keys;
+    auto it = keys.find(key);
+    if (it != keys.end()) return it->second;
+    PyObject* interned = PyUnicode_InternFromString(key);
+    if (interned != nullptr) keys.emplace(key, interned);
+    return interned;
+}
+
+/**
+ * @brief tuple of interned keys, e.g., feature names, to be created once at module initialization
+ * @return new reference
+ */
+static PyObject* pykeys(const std::vector<std::string>& names) {
+    PyObject* tuple = PyTuple_New(names.size());
+    if (tuple == nullptr) return nullptr;
+    for (size_t i = 0; i < names.size(); ++i) {
+        PyObject* key = pykey(names[i].c_str());
+        if (key == nullptr) {
+            Py_DECREF(tuple);
+            return nullptr;
+        }
+        Py_INCREF(key);
+        PyTuple_SET_ITEM(tuple, i, key);
+    }
+    return tuple;
+}
+
 static PyObject* pylist() {
     return PyList_New(0);
 }
 
+// steals the reference to val
+static void pylist_steal(PyObject* list, PyObject* val) {
+    if (val == nullptr) return;
+    PyList_Append(list, val);
+    Py_DECREF(val);
+}
+
 static void pylist(PyObject* list, double val) {
-    PyList_Append(list, pytype(val));
+    pylist_steal(list, pytype(val));
+}
+
+static void pylist(PyObject* list, const char* val) {
+    pylist_steal(list, pytype(val));
 }
 
 static PyObject* pydict() {
     return PyDict_New();
 }
 
+/**
+ * @brief dict[key] = val
+ * @param val new reference, which is stolen
+ */
+static void pydict(PyObject* dict, const char* key, PyObject* val) {
+    if (val == nullptr) return;
+    PyObject* interned = pykey(key);
+    if (interned != nullptr) PyDict_SetItem(dict, interned, val);
+    Py_DECREF(val);
+}
+
 static void pydict(PyObject* dict, const char* key, double val) {
-    PyDict_SetItem(dict, pytype(key), pytype(val));
+    pydict(dict, key, pytype(val));
 }
 
 static void pydict(PyObject* dict, const char* key, const char* val) {
-    PyDict_SetItem(dict, pytype(key), pytype(val));
+    pydict(dict, key, pytype(val));
 }
 
 static void pydict(PyObject* dict, const char* key, int val) {
-    PyDict_SetItem(dict, pytype(key), pytype(val));
+    pydict(dict, key, pytype(val));
 }
 
 static void pydict(PyObject* dict, const char* key, unsigned val) {
-    PyDict_SetItem(dict, pytype(key), pytype(val));
+    pydict(dict, key, pytype(val));
+}
+
+static void pydict(PyObject* dict, const char* key, uint64_t val) {
+    pydict(dict, key, pytype(val));
 }
 
+/**
+ * @brief dict[keys[i]] = record[i] for all i, with keys from pykeys()
+ */
+static void pyrecord(PyObject* dict, PyObject* keys, const std::vector<double>& record) {
+    size_t size = std::min(static_cast<size_t>(PyTuple_GET_SIZE(keys)), record.size());
+    for (size_t i = 0; i < size; ++i) {
+        PyObject* val = PyFloat_FromDouble(record[i]);
+        if (val == nullptr) return;
+        PyDict_SetItem(dict, PyTuple_GET_ITEM(keys, i), val);
+        Py_DECREF(val);
+    }
+}
+
+/**
+ * @brief list of the given leading key followed by the keys from pykeys()
+ * @return new reference
+ */
+static PyObject* pylist(const char* first, PyObject* keys) {
+    PyObject* list = PyList_New(0);
+    if (list == nullptr) return nullptr;
+    pylist(list, first);
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(keys); ++i) {
+        PyList_Append(list, PyTuple_GET_ITEM(keys, i));
+    }
+    return list;
+}
+
+/**
+ * @brief Read-only bytes-like object which owns its buffer, e.g., the content of a file handed over without copy
+ */
+struct PyContent {
+    PyObject_HEAD
+    std::vector<char>* data;
+};
+
+static void pycontent_dealloc(PyObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    delete reinterpret_cast<PyContent*>(self)->data;
+    PyObject_Free(self);
+    Py_DECREF(type);
+}
+
+static int pycontent_getbuffer(PyObject* self, Py_buffer* view, int flags) {
+    std::vector<char>* data = reinterpret_cast<PyContent*>(self)->data;
+    return PyBuffer_FillInfo(view, self, data->data(), data->size(), 1, flags);
+}
+
+/**
+ * @brief memoryview of the given data, which is moved into the object behind the view
+ * @return new reference
+ */
+static PyObject* pycontent(std::vector<char>&& data) {
+    static PyObject* type = nullptr;
+    if (type == nullptr) {
+        static PyType_Slot slots[] = {
+            { Py_tp_dealloc, reinterpret_cast<void*>(pycontent_dealloc) },
+            { Py_bf_getbuffer, reinterpret_cast<void*>(pycontent_getbuffer) },
+            { 0, nullptr }
+        };
+        static PyType_Spec spec = { "gbdc.Content", sizeof(PyContent), 0, Py_TPFLAGS_DEFAULT, slots };
+        type = PyType_FromSpec(&spec);
+        if (type == nullptr) return nullptr;
+    }
+    PyContent* content = PyObject_New(PyContent, reinterpret_cast<PyTypeObject*>(type));
+    if (content == nullptr) return nullptr;
+    content->data = new std::vector<char>(std::move(data));
+    PyObject* view = PyMemoryView_FromObject(reinterpret_cast<PyObject*>(content));
+    Py_DECREF(content);
+    return view;
+}
+
+/**
+ * @brief Input given either as path (str) or as content of a file (bytes-like object, compressed or not)
+ * Content is read in place through the buffer protocol, it is registered as MemoryFile for the lifetime of PyInput.
+ */
+class PyInput {
+    Py_buffer view_;
+    bool has_view_;
+    std::unique_ptr<MemoryFile> memory_;
+    const char* filename_;
+
+ public:
+    PyInput() : view_(), has_view_(false), memory_(), filename_(nullptr) { }
+
+    ~PyInput() {
+        memory_.reset();
+        if (has_view_) PyBuffer_Release(&view_);
+    }
+
+    PyInput(const PyInput&) = delete;
+    PyInput& operator=(const PyInput&) = delete;
+
+    /**
+     * @brief converter for the "O&" format of PyArg_ParseTuple
+     */
+    static int convert(PyObject* object, void* address) {
+        PyInput* input = static_cast<PyInput*>(address);
+        if (PyUnicode_Check(object)) {
+            input->filename_ = PyUnicode_AsUTF8(object);
+            return input->filename_ != nullptr;
+        }
+        if (PyObject_CheckBuffer(object) && PyObject_GetBuffer(object, &input->view_, PyBUF_SIMPLE) == 0) {
+            input->has_view_ = true;
+            input->memory_.reset(new MemoryFile(input->view_.buf, input->view_.len));
+            input->filename_ = input->memory_->name();
+            return 1;
+        }
+        if (!PyErr_Occurred()) PyErr_SetString(PyExc_TypeError, "expected path (str) or content of file (bytes-like object)");
+        return 0;
+    }
+
+    const char* filename() const {
+        return filename_;
+    }
+};
+
 #endif  // SRC_UTIL_PY_UTIL_H_